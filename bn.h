@@ -1,12 +1,21 @@
 #pragma once
 //  bn.h
 
+#include <stdio.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct bn_s;
 
 typedef struct bn_s bn;
 
 /*enum bn_codes {
-BN_OK, BN_NULL_OBJECT, BN_NO_MEMORY, BN_DIVIDE_BY_ZERO
+BN_OK, BN_NULL_OBJECT, BN_NO_MEMORY, BN_DIVIDE_BY_ZERO,
+BN_SHORT_BUFFER, BN_BAD_FORMAT, BN_IO_ERROR, BN_NO_INVERSE,
+BN_CANCELLED, BN_INEXACT
 }; */
 
 bn *bn_new(); //   BN
@@ -35,6 +44,18 @@ int bn_mod_to(bn *t, bn const *right);
 //     degree
 int bn_pow_to(bn *t, int degree);
 
+//  orig! (NULL  orig < 1)
+bn* bn_factorial(int orig);
+
+//   F(n)   L(n), n >= 0 ( )
+bn* bn_fib(int n);
+bn* bn_lucas(int n);
+//   C(n, k)     
+// (0  k < 0  k > n)
+bn* bn_binomial(int n, int k);
+//    ,   n
+bn* bn_primorial(int n);
+
 //    reciprocal  BN ( )
 int bn_root_to(bn *t, int reciprocal);
 
@@ -45,13 +66,164 @@ bn* bn_mul(bn const *left, bn const *right);
 bn* bn_div(bn const *left, bn const *right);
 bn* bn_mod(bn const *left, bn const *right);
 
+//   dst = a+b (a-b, a*b, a/b, a%b)     dst.
+// dst    a / b.
+int bn_add_into(bn *dst, bn const *a, bn const *b);
+int bn_sub_into(bn *dst, bn const *a, bn const *b);
+int bn_mul_into(bn *dst, bn const *a, bn const *b);
+int bn_div_into(bn *dst, bn const *a, bn const *b);
+int bn_mod_into(bn *dst, bn const *a, bn const *b);
+// dst = src     dst:     src
+int bn_copy_into(bn *dst, bn const *src);
+
 //   BN    radix   
 //     .
+//        radix != 10
+//   ,        
+//    (bn_to_string, bn_to_string_buf).  
+// 65536    ,     .
 const char *bn_to_string(bn const *t, int radix);
 
+//   BN    radix  :   radix 10,
+//    (      2)
+size_t bn_sizeinbase(bn const *t, int radix);
+
+//   BN   buf  len   .
+//  len = bn_sizeinbase(t, radix) + 2 (   ).
+int bn_to_string_buf(bn const *t, int radix, char *buf, size_t len);
+
 //   ,  <0;  ,  0;  >0
 int bn_cmp(bn const *left, bn const *right);
 
 int bn_neg(bn *t); //    
 int bn_abs(bn *t); //  
 int bn_sign(bn const *t); //-1  t<0; 0  t = 0, 1  t>0
+
+//   BN:   24  (, , ,
+//  ,   Adler-32)   uint32 little-endian.
+// bn_export    (9    ),
+// bn_export_view -         .
+//  ,  bn_export (bn_export_view)
+size_t bn_export_size(bn const *t);
+size_t bn_export_view_size(bn const *t);
+//  BN   buf  len
+int bn_export(bn const *t, void *buf, size_t len);
+int bn_export_view(bn const *t, void *buf, size_t len);
+//  BN  ,  bn_export  bn_export_view
+int bn_import(bn *t, void const *buf, size_t len);
+
+//  ,  bn_export_view,    
+//  (  bn_export    ).
+//    ;   bn_view_close.
+bn const *bn_view_mmap(const char *path);
+int bn_view_close(bn const *t);
+
+//   BN    radix   f
+//    .  radix 10 -    
+//  ;     O(n) 
+// (    )  O(n^2) .
+int bn_write(FILE *f, bn const *t, int radix);
+//  BN    radix   f
+int bn_read(FILE *f, bn *t, int radix);
+
+//    (),  
+bn* bn_gcd(bn const *left, bn const *right);
+// g = gcd(left, right) = left*s + right*t; s  t   NULL
+int bn_gcdext(bn *g, bn *s, bn *t, bn const *left, bn const *right);
+// t = a^(-1) mod m   [0, |m|); BN_NO_INVERSE,   
+int bn_invert(bn *t, bn const *a, bn const *m);
+
+//  ;      
+//  .   bits : t *= 2^bits, t = floor(t / 2^bits)
+int bn_shl(bn *t, int bits);
+int bn_shr(bn *t, int bits);
+//   x = l&r (l|r, l^r)
+bn* bn_and(bn const *left, bn const *right);
+bn* bn_or(bn const *left, bn const *right);
+bn* bn_xor(bn const *left, bn const *right);
+int bn_not(bn *t); // t = ~t
+int bn_popcount(bn const *t); //   ; -1  t<0
+int bn_testbit(bn const *t, int bit); //   bit; -1   
+int bn_setbit(bn *t, int bit); //   bit
+int bn_scan1(bn const *t, int start); //       start; -1,       
+
+//      : acc += a*b, acc -= a*b
+int bn_addmul(bn *acc, bn const *a, bn const *b);
+int bn_submul(bn *acc, bn const *a, bn const *b);
+
+//  |t|  : 2 -  , 1 -  ,
+// 0 - , -1 - .      1000, 
+//  BPSW (-   2    )  
+// reps  -   3, 5, 7, ...
+int bn_probab_prime(bn const *t, int reps);
+
+// t =    ,  orig
+int bn_nextprime(bn *t, bn const *orig);
+
+//      count  ( 
+// ;        OpenMP).
+// t = v[0] * v[1] * ... * v[count-1];  count = 0 t = 1
+int bn_prod_tree(bn *t, bn * const *v, int count);
+// res[i] = t % m[i] ( bn_mod)   
+int bn_multi_mod(bn * const *res, bn const *t, bn * const *m, int count);
+//    : t = x,  x = r[i] (mod m[i]) 
+// 0 <= x < |m[0] * ... * m[count-1]|.    
+//  ,  BN_NO_INVERSE.
+int bn_crt(bn *t, bn * const *r, bn * const *m, int count);
+
+//  :       .
+// progress (  NULL)      
+//    0  1.     .
+struct bn_job_s;
+typedef struct bn_job_s bn_job;
+typedef void (*bn_progress_fn)(void *arg, double done);
+
+bn_job *bn_factorial_async(int n, bn_progress_fn progress, void *arg); // n! (NULL  n < 1)
+bn_job *bn_pow_async(bn const *t, int degree, bn_progress_fn progress, void *arg); // t^degree
+bn_job *bn_to_string_async(bn const *t, int radix, bn_progress_fn progress, void *arg);
+
+//  ;   (BN_CANCELLED,  )
+int bn_job_wait(bn_job *job);
+int bn_job_ready(bn_job *job); // 1,   
+//  ;    () 
+int bn_job_cancel(bn_job *job);
+//   ( ); NULL    .
+//   : bn_delete / free.
+bn *bn_job_result(bn_job *job);
+const char *bn_job_string(bn_job *job);
+//     
+int bn_job_free(bn_job *job);
+
+//      :    
+// min_digits    ( )   
+// dir,   ,       
+//       .
+// dir = NULL  .      .
+// :     (O(n*m) ), 
+//     int,      INT_MAX (~2^31) .
+int bn_spill(const char *dir, int min_digits);
+
+// dst = a / b,   ,  b  a  ( 
+//   ).  NDEBUG  ,   
+//  BN_INEXACT;  NDEBUG    a  .
+int bn_divexact(bn *dst, bn const *a, bn const *b);
+
+//    .    
+// p(n), q(n), a(n) (NULL  1),     t:
+//   S = sum_{n=0}^{count-1} a(n) * p(0)...p(n) / (q(0)...q(n)).
+//        P, Q, T
+//  ,     .
+typedef int (*bn_term_fn)(bn *t, long n, void *arg);
+typedef struct {
+    bn_term_fn p, q, a;
+    void *arg;
+} bn_series;
+
+// t = floor(S * 10^digits).  threads > 1  
+//    ,      
+// .
+int bn_series_sum(bn *t, bn_series const *s, long count, int digits, int threads);
+
+#ifdef __cplusplus
+}
+#endif
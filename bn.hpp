@@ -0,0 +1,393 @@
+#pragma once
+//  bn.hpp:  BigInt  bn.h  C++11
+
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include "bn.h"
+
+class BigInt;
+
+namespace bn_detail {
+
+//   bn.h
+enum { OK, NULL_OBJECT, NO_MEMORY, DIVIDE_BY_ZERO };
+
+inline void check(int code) {
+    if (code == OK) return;
+    if (code == NO_MEMORY) throw std::bad_alloc();
+    if (code == DIVIDE_BY_ZERO) throw std::domain_error("bn: division by zero");
+    throw std::runtime_error("bn: operation failed");
+}
+
+inline bn *check_ptr(bn *p) {
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+//   dst  
+inline void replace(bn *&dst, bn *result) {
+    check_ptr(result);
+    bn_delete(dst);
+    dst = result;
+}
+
+struct Add {
+    enum { commutative = 1, negatable = 0 };
+    static int to(bn *t, bn const *r) { return bn_add_to(t, r); }
+    static int into(bn *d, bn const *l, bn const *r) { return bn_add_into(d, l, r); }
+};
+
+struct Sub {
+    enum { commutative = 0, negatable = 1 };
+    static int to(bn *t, bn const *r) { return bn_sub_to(t, r); }
+    static int into(bn *d, bn const *l, bn const *r) { return bn_sub_into(d, l, r); }
+};
+
+struct Mul {
+    enum { commutative = 1, negatable = 0 };
+    static int to(bn *t, bn const *r) { return bn_mul_to(t, r); }
+    static int into(bn *d, bn const *l, bn const *r) { return bn_mul_into(d, l, r); }
+};
+
+struct Div {
+    enum { commutative = 0, negatable = 0 };
+    static int to(bn *t, bn const *r) { return bn_div_to(t, r); }
+    static int into(bn *d, bn const *l, bn const *r) { return bn_div_into(d, l, r); }
+};
+
+struct Mod {
+    enum { commutative = 0, negatable = 0 };
+    static int to(bn *t, bn const *r) { return bn_mod_to(t, r); }
+    static int into(bn *d, bn const *l, bn const *r) { return bn_mod_into(d, l, r); }
+};
+
+template <class Op, class L, class R> struct Expr;
+
+//  (BigInt)   ,  -  
+template <class T> struct Operand { typedef T type; };
+template <> struct Operand<BigInt> { typedef BigInt const &type; };
+
+template <class T> struct IsLeaf { enum { value = 0 }; };
+template <> struct IsLeaf<BigInt> { enum { value = 1 }; };
+
+template <class T> struct IsOperand { enum { value = 0 }; };
+template <> struct IsOperand<BigInt> { enum { value = 1 }; };
+template <class Op, class L, class R> struct IsOperand<Expr<Op, L, R> > { enum { value = 1 }; };
+
+template <bool B, class T> struct EnableIf {};
+template <class T> struct EnableIf<true, T> { typedef T type; };
+
+bn const *leaf(BigInt const &x);
+bool uses(BigInt const &x, bn const *p);
+void eval_into(bn *&dst, BigInt const &x);
+
+template <class Op, class L, class R>
+bool uses(Expr<Op, L, R> const &e, bn const *p) { return uses(e.l, p) || uses(e.r, p); }
+
+template <class Op, class L, class R>
+void eval_into(bn *&dst, Expr<Op, L, R> const &e) { e.eval_into(dst); }
+
+//  :   , 
+//     bn
+class Temp {
+public:
+    explicit Temp(BigInt const &x) : p(leaf(x)), own(NULL) {}
+    template <class Op, class L, class R>
+    explicit Temp(Expr<Op, L, R> const &e) : p(NULL), own(check_ptr(bn_new())) {
+        try {
+            e.eval_into(own);
+        } catch (...) {
+            bn_delete(own);
+            throw;
+        }
+        p = own;
+    }
+    ~Temp() { if (own != NULL) bn_delete(own); }
+    bn const *get() const { return p; }
+    bool owned() const { return own != NULL; }
+    bn *take() { return own; }
+    bn *release() { bn *r = own; own = NULL; return r; }
+private:
+    Temp(Temp const &);
+    Temp &operator=(Temp const &);
+    bn const *p;
+    bn *own;
+};
+
+typedef Expr<Mul, BigInt, BigInt> Product;
+
+//       BigInt  
+// bn_addmul/bn_submul   
+template <class Op, class L, class R>
+struct Fused {
+    template <class E> static bool run(E const &, bn *&) { return false; }
+};
+
+template <class L>
+struct Fused<Add, L, Product> {
+    template <class E> static bool run(E const &e, bn *&dst) {
+        if (uses(e.r, dst) && !(IsLeaf<L>::value && uses(e.l, dst))) return false;
+        eval_into(dst, e.l);
+        check(bn_addmul(dst, leaf(e.r.l), leaf(e.r.r)));
+        return true;
+    }
+};
+
+template <class R>
+struct Fused<Add, Product, R> {
+    template <class E> static bool run(E const &e, bn *&dst) {
+        if (uses(e.l, dst) && !(IsLeaf<R>::value && uses(e.r, dst))) return false;
+        eval_into(dst, e.r);
+        check(bn_addmul(dst, leaf(e.l.l), leaf(e.l.r)));
+        return true;
+    }
+};
+
+template <>
+struct Fused<Add, Product, Product> {
+    template <class E> static bool run(E const &e, bn *&dst) {
+        if (uses(e.r, dst)) return false;
+        eval_into(dst, e.l);
+        check(bn_addmul(dst, leaf(e.r.l), leaf(e.r.r)));
+        return true;
+    }
+};
+
+template <class L>
+struct Fused<Sub, L, Product> {
+    template <class E> static bool run(E const &e, bn *&dst) {
+        if (uses(e.r, dst) && !(IsLeaf<L>::value && uses(e.l, dst))) return false;
+        eval_into(dst, e.l);
+        check(bn_submul(dst, leaf(e.r.l), leaf(e.r.r)));
+        return true;
+    }
+};
+
+template <class R>
+struct Fused<Sub, Product, R> {
+    template <class E> static bool run(E const &e, bn *&dst) {
+        if (uses(e.l, dst) && !(IsLeaf<R>::value && uses(e.r, dst))) return false;
+        eval_into(dst, e.r);
+        check(bn_neg(dst));
+        check(bn_addmul(dst, leaf(e.l.l), leaf(e.l.r)));
+        return true;
+    }
+};
+
+template <>
+struct Fused<Sub, Product, Product> {
+    template <class E> static bool run(E const &e, bn *&dst) {
+        if (uses(e.r, dst)) return false;
+        eval_into(dst, e.l);
+        check(bn_submul(dst, leaf(e.r.l), leaf(e.r.r)));
+        return true;
+    }
+};
+
+template <class Op, class L, class R>
+struct Expr {
+    typename Operand<L>::type l;
+    typename Operand<R>::type r;
+
+    Expr(L const &left, R const &right) : l(left), r(right) {}
+
+    //     dst,   BigInt
+    void eval_into(bn *&dst) const {
+        if (Fused<Op, L, R>::run(*this, dst)) return;
+        if (!IsLeaf<L>::value && !uses(r, dst)) {
+            bn_detail::eval_into(dst, l);
+            Temp rt(r);
+            check(Op::to(dst, rt.get()));
+            return;
+        }
+        if (IsLeaf<L>::value && !IsLeaf<R>::value && !uses(l, dst)) {
+            Temp lt(l);
+            if (Op::commutative) {
+                bn_detail::eval_into(dst, r);
+                check(Op::to(dst, lt.get()));
+                return;
+            }
+            if (Op::negatable) {
+                bn_detail::eval_into(dst, r);
+                check(bn_neg(dst));
+                check(bn_add_to(dst, lt.get()));
+                return;
+            }
+        }
+        Temp lt(l), rt(r);
+        if (lt.owned()) {
+            check(Op::to(lt.take(), rt.get()));
+            replace(dst, lt.release());
+        } else {
+            //     dst,   dst -   
+            check(Op::into(dst, lt.get(), rt.get()));
+        }
+    }
+};
+
+} // namespace bn_detail
+
+class BigInt {
+public:
+    BigInt() : p(bn_detail::check_ptr(bn_new())) {}
+    BigInt(int value) : p(bn_detail::check_ptr(bn_new())) {
+        init(bn_init_int(p, value));
+    }
+    explicit BigInt(const char *s, int radix = 10) : p(bn_detail::check_ptr(bn_new())) {
+        init(radix == 10 ? bn_init_string(p, s) : bn_init_string_radix(p, s, radix));
+    }
+    explicit BigInt(std::string const &s, int radix = 10) : p(bn_detail::check_ptr(bn_new())) {
+        init(radix == 10 ? bn_init_string(p, s.c_str()) : bn_init_string_radix(p, s.c_str(), radix));
+    }
+    BigInt(BigInt const &o) : p(bn_detail::check_ptr(bn_init(o.p))) {}
+    //       ,
+    //    
+    BigInt(BigInt &&o) : p(bn_detail::check_ptr(bn_new())) {
+        bn *tmp = p;
+        p = o.p;
+        o.p = tmp;
+    }
+    template <class Op, class L, class R>
+    BigInt(bn_detail::Expr<Op, L, R> const &e) : p(bn_detail::check_ptr(bn_new())) {
+        try {
+            e.eval_into(p);
+        } catch (...) {
+            bn_delete(p);
+            throw;
+        }
+    }
+    ~BigInt() { bn_delete(p); }
+
+    BigInt &operator=(BigInt const &o) {
+        if (this != &o) bn_detail::replace(p, bn_init(o.p));
+        return *this;
+    }
+    BigInt &operator=(BigInt &&o) noexcept {
+        bn *tmp = p;
+        p = o.p;
+        o.p = tmp;
+        return *this;
+    }
+    template <class Op, class L, class R>
+    BigInt &operator=(bn_detail::Expr<Op, L, R> const &e) {
+        e.eval_into(p);
+        return *this;
+    }
+
+    template <class T>
+    typename bn_detail::EnableIf<bn_detail::IsOperand<T>::value, BigInt &>::type operator+=(T const &r) {
+        return apply<bn_detail::Add>(r);
+    }
+    template <class T>
+    typename bn_detail::EnableIf<bn_detail::IsOperand<T>::value, BigInt &>::type operator-=(T const &r) {
+        return apply<bn_detail::Sub>(r);
+    }
+    template <class T>
+    typename bn_detail::EnableIf<bn_detail::IsOperand<T>::value, BigInt &>::type operator*=(T const &r) {
+        return apply<bn_detail::Mul>(r);
+    }
+    template <class T>
+    typename bn_detail::EnableIf<bn_detail::IsOperand<T>::value, BigInt &>::type operator/=(T const &r) {
+        return apply<bn_detail::Div>(r);
+    }
+    template <class T>
+    typename bn_detail::EnableIf<bn_detail::IsOperand<T>::value, BigInt &>::type operator%=(T const &r) {
+        return apply<bn_detail::Mod>(r);
+    }
+
+    BigInt &operator+=(bn_detail::Product const &e) {
+        bn_detail::check(bn_addmul(p, e.l.get(), e.r.get()));
+        return *this;
+    }
+    BigInt &operator-=(bn_detail::Product const &e) {
+        bn_detail::check(bn_submul(p, e.l.get(), e.r.get()));
+        return *this;
+    }
+
+    BigInt operator-() const {
+        BigInt r(*this);
+        bn_detail::check(bn_neg(r.p));
+        return r;
+    }
+
+    BigInt &pow(int degree) { bn_detail::check(bn_pow_to(p, degree)); return *this; }
+    BigInt &root(int reciprocal) { bn_detail::check(bn_root_to(p, reciprocal)); return *this; }
+
+    int sign() const { return bn_sign(p); }
+    int compare(BigInt const &o) const { return bn_cmp(p, o.p); }
+
+    std::string to_string(int radix = 10) const {
+        const char *s = bn_to_string(p, radix);
+        if (s == NULL) throw std::bad_alloc();
+        std::string r(s);
+        std::free((void *)s);
+        return r;
+    }
+
+    bn *get() { return p; }
+    bn const *get() const { return p; }
+    //   bn ;    
+    bn *release() {
+        bn *zero = bn_detail::check_ptr(bn_new());
+        bn *r = p;
+        p = zero;
+        return r;
+    }
+
+private:
+    void init(int code) {
+        if (code != bn_detail::OK) {
+            bn_delete(p);
+            bn_detail::check(code);
+        }
+    }
+
+    template <class Op, class T>
+    BigInt &apply(T const &r) {
+        bn_detail::Temp rt(r);
+        bn_detail::check(Op::to(p, rt.get()));
+        return *this;
+    }
+
+    bn *p;
+};
+
+namespace bn_detail {
+
+inline bn const *leaf(BigInt const &x) { return x.get(); }
+inline bool uses(BigInt const &x, bn const *p) { return x.get() == p; }
+inline void eval_into(bn *&dst, BigInt const &x) {
+    check(bn_copy_into(dst, x.get()));
+}
+
+} // namespace bn_detail
+
+#define BN_CPP_OPERATOR(op, Op) \
+    template <class L, class R> \
+    typename bn_detail::EnableIf<bn_detail::IsOperand<L>::value && bn_detail::IsOperand<R>::value, \
+                                 bn_detail::Expr<bn_detail::Op, L, R> >::type \
+    operator op(L const &l, R const &r) { \
+        return bn_detail::Expr<bn_detail::Op, L, R>(l, r); \
+    }
+
+BN_CPP_OPERATOR(+, Add)
+BN_CPP_OPERATOR(-, Sub)
+BN_CPP_OPERATOR(*, Mul)
+BN_CPP_OPERATOR(/, Div)
+BN_CPP_OPERATOR(%, Mod)
+
+#undef BN_CPP_OPERATOR
+
+inline bool operator==(BigInt const &l, BigInt const &r) { return l.compare(r) == 0; }
+inline bool operator!=(BigInt const &l, BigInt const &r) { return l.compare(r) != 0; }
+inline bool operator<(BigInt const &l, BigInt const &r) { return l.compare(r) < 0; }
+inline bool operator>(BigInt const &l, BigInt const &r) { return l.compare(r) > 0; }
+inline bool operator<=(BigInt const &l, BigInt const &r) { return l.compare(r) <= 0; }
+inline bool operator>=(BigInt const &l, BigInt const &r) { return l.compare(r) >= 0; }
+
+inline std::ostream &operator<<(std::ostream &os, BigInt const &x) {
+    return os << x.to_string();
+}
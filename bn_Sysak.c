@@ -1,18 +1,204 @@
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "bn.h"
 
 enum bn_codes {
-    BN_OK, BN_NULL_OBJECT, BN_NO_MEMORY, BN_DIVIDE_BY_ZERO
+    BN_OK, BN_NULL_OBJECT, BN_NO_MEMORY, BN_DIVIDE_BY_ZERO,
+    BN_SHORT_BUFFER, BN_BAD_FORMAT, BN_IO_ERROR, BN_NO_INVERSE,
+    BN_CANCELLED, BN_INEXACT
 };
 
+typedef struct {
+    int    radix;
+    size_t len;
+    char   text[1];
+} bn_text;
+
 struct bn_s {
-    int *body;
-    int  bodysize;
-    int  sign;
+    int     *body;
+    int      bodysize;
+    int      sign;
+    int      external;
+    bn_text *text;
+};
+
+typedef struct {
+    long refs;
+    int  cap;
+    int  kind;
+} bn_hdr;
+
+#define BN_HDR(body) ((bn_hdr *)(body) - 1)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define bn_refs_inc(p) _InterlockedIncrement(p)
+#define bn_refs_dec(p) _InterlockedDecrement(p)
+#define bn_refs_get(p) (*(long volatile *)(p))
+#define bn_flag_set(p) _InterlockedExchange(p, 1)
+#define bn_text_get(p) ((bn_text *)*(void * volatile *)(p))
+#define bn_text_cas(p, n) (_InterlockedCompareExchangePointer((void * volatile *)(p), (n), NULL) == NULL)
+#else
+#define bn_refs_inc(p) __atomic_add_fetch(p, 1, __ATOMIC_RELAXED)
+#define bn_refs_dec(p) __atomic_sub_fetch(p, 1, __ATOMIC_ACQ_REL)
+#define bn_refs_get(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define bn_flag_set(p) __atomic_store_n(p, 1, __ATOMIC_RELEASE)
+#define bn_text_get(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define bn_text_cas(p, n) __sync_bool_compare_and_swap(p, (bn_text *)NULL, n)
+#endif
+
+typedef struct {
+    long *cancel;
+    bn_progress_fn progress;
+    void *arg;
+} bn_ctl;
+
+enum bn_body_kinds {
+    BN_BODY_HEAP, BN_BODY_FILE
 };
 
+#define BN_SPILL_PATH 4096
+
+static char bn_spill_dir[BN_SPILL_PATH];
+static int bn_spill_min;
+
+int bn_spill_wanted(int n) {
+    return bn_spill_min > 0 && n >= bn_spill_min;
+}
+
+int *bn_body_map(int n) {
+#ifndef _WIN32
+    size_t len = sizeof(bn_hdr) + (size_t)n * sizeof(int);
+    char path[BN_SPILL_PATH + 16];
+    snprintf(path, sizeof(path), "%s/bnXXXXXX", bn_spill_dir);
+    int fd = mkstemp(path);
+    if (fd < 0) return NULL;
+    unlink(path);
+    void *p = MAP_FAILED;
+    if (ftruncate(fd, (off_t)len) == 0) {
+        p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+    madvise(p, len, MADV_SEQUENTIAL);
+    bn_hdr *h = (bn_hdr *)p;
+    h->refs = 1;
+    h->cap = n;
+    h->kind = BN_BODY_FILE;
+    return (int *)(h + 1);
+#else
+    return NULL;
+#endif
+}
+
+int *bn_body_alloc(int n) {
+    if (bn_spill_wanted(n)) {
+        int *r = bn_body_map(n);
+        if (r != NULL) return r;
+    }
+    bn_hdr *h = (bn_hdr *)malloc(sizeof(bn_hdr) + (size_t)n * sizeof(int));
+    if (h == NULL) return NULL;
+    h->refs = 1;
+    h->cap = n;
+    h->kind = BN_BODY_HEAP;
+    return (int *)(h + 1);
+}
+
+void bn_body_drop(int *body) {
+    bn_hdr *h = BN_HDR(body);
+#ifndef _WIN32
+    if (h->kind == BN_BODY_FILE) {
+        munmap(h, sizeof(bn_hdr) + (size_t)h->cap * sizeof(int));
+        return;
+    }
+#endif
+    free(h);
+}
+
+int *bn_body_calloc(int n) {
+    int *r = bn_body_alloc(n);
+    if (r != NULL) memset(r, 0, (size_t)n * sizeof(int));
+    return r;
+}
+
+int *bn_body_realloc(int *body, int n) {
+    if (BN_HDR(body)->kind == BN_BODY_FILE || bn_spill_wanted(n)) {
+        int *r = bn_body_alloc(n);
+        if (r == NULL) return NULL;
+        int cap = BN_HDR(body)->cap;
+        memcpy(r, body, (size_t)(cap < n ? cap : n) * sizeof(int));
+        bn_body_drop(body);
+        return r;
+    }
+    bn_hdr *h = (bn_hdr *)realloc(BN_HDR(body), sizeof(bn_hdr) + (size_t)n * sizeof(int));
+    if (h == NULL) return NULL;
+    h->cap = n;
+    return (int *)(h + 1);
+}
+
+void bn_body_free(int *body) {
+    if (body != NULL && bn_refs_dec(&BN_HDR(body)->refs) == 0) {
+        bn_body_drop(body);
+    }
+}
+
+void bn_uncache(bn *t) {
+    free(t->text);
+    t->text = NULL;
+}
+
+void bn_release(bn *t) {
+    bn_uncache(t);
+    if (!t->external) bn_body_free(t->body);
+    t->body = NULL;
+    t->external = 0;
+}
+
+int bn_unique(bn const *t) {
+    return !t->external && bn_refs_get(&BN_HDR(t->body)->refs) == 1;
+}
+
+int bn_body_resize(bn *t, int n) {
+    bn_uncache(t);
+    if (bn_unique(t)) {
+        if (BN_HDR(t->body)->cap >= n) return BN_OK;
+        int *r = bn_body_realloc(t->body, n);
+        if (r == NULL) return BN_NO_MEMORY;
+        t->body = r;
+        return BN_OK;
+    }
+    int *r = bn_body_alloc(n);
+    if (r == NULL) return BN_NO_MEMORY;
+    memcpy(r, t->body, (size_t)(t->bodysize < n ? t->bodysize : n) * sizeof(int));
+    bn_release(t);
+    t->body = r;
+    return BN_OK;
+}
+
+int bn_unshare(bn *t) {
+    return bn_body_resize(t, t->bodysize);
+}
+
+void bn_evict(bn const *t, int from, int to) {
+#ifndef _WIN32
+    if (t->external || BN_HDR(t->body)->kind != BN_BODY_FILE) return;
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t lo = ((uintptr_t)(t->body + from) + page - 1) / page * page;
+    uintptr_t hi = (uintptr_t)(t->body + to) / page * page;
+    if (hi > lo) madvise((void *)lo, hi - lo, MADV_DONTNEED);
+#endif
+}
 
 
 void bn_print(bn *t) {
@@ -43,138 +229,336 @@ int bn_first_zeros(bn *t) {
     }
     if (i == t->bodysize - 1) return BN_OK;
     if (i < 0) {
-        free(t->body);
+        bn_release(t);
         t->sign = 0;
         t->bodysize = 1;
-        t->body = (int *)malloc(t->bodysize * sizeof(int));
+        t->body = bn_body_alloc(t->bodysize);
         if (t->body == NULL) return BN_NO_MEMORY;
         t->body[0] = 0;
         return BN_OK;
     }
     t->bodysize = i + 1;
-    int *r = (int *)malloc(t->bodysize * sizeof(int));
+    int *r = bn_body_alloc(t->bodysize);
     if (r == NULL) return BN_NO_MEMORY;
     int j;
     for (j = 0; j < t->bodysize; j++) {
         r[j] = t->body[j];
     }
-    free(t->body);
+    bn_release(t);
     t->body = r;
     return BN_OK;
 }
 
-bn *bn_add_same_sign(bn const *left, bn const *right) {
-    bn *ret = (bn *)malloc(sizeof(bn));
-    if (ret == NULL) return NULL;
-    int last = 0;
-    if (left->bodysize > right->bodysize) {
-        ret->bodysize = left->bodysize;
-        if (left->body[left->bodysize - 1] == 9)
-            last = 1;
-    } else if (left->bodysize < right->bodysize) {
-        ret->bodysize = right->bodysize;
-        if (right->body[right->bodysize - 1] == 9)
-            last = 1;
+int bn_radix_chunk(int radix, int *width) {
+    int p = radix, w = 1;
+    while (p <= 100000000 / radix) {
+        p *= radix;
+        w++;
+    }
+    *width = w;
+    return p;
+}
+
+int bn_mul_small_add(bn *t, int m, int a) {
+    if (bn_body_resize(t, t->bodysize + 10)) return BN_NO_MEMORY;
+    long long carry = a;
+    int i;
+    for (i = 0; i < t->bodysize; i++) {
+        carry += (long long)t->body[i] * m;
+        t->body[i] = (int)(carry % 10);
+        carry /= 10;
+    }
+    while (carry > 0) {
+        t->body[t->bodysize++] = (int)(carry % 10);
+        carry /= 10;
+    }
+    while (t->bodysize > 1 && t->body[t->bodysize - 1] == 0) {
+        t->bodysize--;
+    }
+    if (t->sign == 0 && t->body[t->bodysize - 1] != 0) {
+        t->sign = 1;
+    }
+    return BN_OK;
+}
+
+int bn_digit_value(int c, int radix) {
+    int d;
+    if (c >= '0' && c <= '9') {
+        d = c - '0';
+    } else if (c >= 'A' && c <= 'Z') {
+        d = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'z') {
+        d = c - 'a' + 10;
     } else {
-        ret->bodysize = left->bodysize;
-        if (right->body[right->bodysize - 1] + left->body[left->bodysize - 1] >= 9)
-            last = 1;
-    }
-    if (last)
-        ret->bodysize++;
-    ret->sign = left->sign;
-    ret->body = (int *)malloc(ret->bodysize * sizeof(int));
-    if (ret->body == NULL) {
-        free(ret);
-        return NULL;
+        return -1;
     }
-    int i, next = 0;
-    for (i = 0; i < ret->bodysize - last; i++) {
-        if (i < left->bodysize)
-            next += left->body[i];
-        if (i < right->bodysize)
-            next += right->body[i];
-        ret->body[i] = next % 10;
-        next /= 10;
-    }
-    if (last) {
-        ret->body[ret->bodysize - 1] = next;
-        if (last && (next == 0)) {
-            if (bn_first_zeros(ret)) {
-                bn_delete(ret);
-                return NULL;
-            }
-        }
+    return d < radix ? d : -1;
+}
+
+void bn_trim(bn *t, int size, int sign) {
+    bn_uncache(t);
+    while (size > 1 && t->body[size - 1] == 0) {
+        size--;
     }
-    return ret;
+    t->bodysize = size;
+    t->sign = (size == 1 && t->body[0] == 0) ? 0 : sign;
 }
 
-bn *bn_add_diff_sign(bn const *left, bn const *right) {
-    bn *ret = (bn *)malloc(sizeof(bn));
-    if (ret == NULL) return NULL;
-    int i, left_bigger = 0;
-    if (left->bodysize > right->bodysize) {
-        ret->bodysize = left->bodysize;
-        left_bigger = 1;
-    } else if (left->bodysize < right->bodysize) {
-        ret->bodysize = right->bodysize;
-        left_bigger = 0;
+int bn_set_digits(bn *t, int *body, int size, int sign) {
+    bn_release(t);
+    t->body = body;
+    bn_trim(t, size, sign);
+    return BN_OK;
+}
+
+int bn_reserve(bn *t, int n) {
+    bn_uncache(t);
+    if (t->body != NULL && bn_unique(t) && BN_HDR(t->body)->cap >= n) return BN_OK;
+    bn_release(t);
+    t->body = bn_body_alloc(n);
+    return t->body == NULL ? BN_NO_MEMORY : BN_OK;
+}
+
+int bn_assign(bn *t, bn const *src) {
+    if (t == src) return BN_OK;
+    if (src->external) {
+        if (bn_reserve(t, src->bodysize)) return BN_NO_MEMORY;
+        memcpy(t->body, src->body, src->bodysize * sizeof(int));
     } else {
-        ret->bodysize = left->bodysize;
-        for (i = left->bodysize - 1; i >= 0; i--) {
-            if (left->body[i] > right->body[i]) {
-                left_bigger = 1;
-                break;
+        bn_refs_inc(&BN_HDR(src->body)->refs);
+        bn_release(t);
+        t->body = src->body;
+    }
+    t->bodysize = src->bodysize;
+    t->sign = src->sign;
+    return BN_OK;
+}
+
+int bn_move(bn *t, bn *src) {
+    bn_release(t);
+    t->body = src->body;
+    t->bodysize = src->bodysize;
+    t->sign = src->sign;
+    t->external = src->external;
+    bn_uncache(src);
+    free(src);
+    return BN_OK;
+}
+
+int bn_set_zero(bn *t) {
+    if (bn_reserve(t, 1)) return BN_NO_MEMORY;
+    t->body[0] = 0;
+    t->bodysize = 1;
+    t->sign = 0;
+    return BN_OK;
+}
+
+int bn_ctl_step(bn_ctl *ctl, double done) {
+    if (ctl == NULL) return BN_OK;
+    if (ctl->progress != NULL) ctl->progress(ctl->arg, done);
+    return ctl->cancel != NULL && bn_refs_get(ctl->cancel) ? BN_CANCELLED : BN_OK;
+}
+
+int bn_init_ll(bn *t, long long x) {
+    int *r = bn_body_alloc(20);
+    if (r == NULL) return BN_NO_MEMORY;
+    int sign = x < 0 ? -1 : 1;
+    unsigned long long u = x < 0 ? 0ull - (unsigned long long)x : (unsigned long long)x;
+    int size = 0;
+    do {
+        r[size++] = (int)(u % 10);
+        u /= 10;
+    } while (u > 0);
+    return bn_set_digits(t, r, size, sign);
+}
+
+int bn_divmod_abs(bn *q, bn *r, bn const *a, bn const *b, int *inexact) {
+    if (b->sign == 0) return BN_DIVIDE_BY_ZERO;
+    int na = a->bodysize, nb = b->bodysize;
+    int nq = na >= nb ? na - nb + 1 : 1;
+    bn *rdst = (r != NULL && r != b) ? r : NULL;
+    bn *qdst = (q != NULL && q != a && q != b && q != r) ? q : NULL;
+    int *rem, *quot;
+    if (rdst != NULL) {
+        if (bn_body_resize(rdst, na + 1)) return BN_NO_MEMORY;
+        rem = rdst->body;
+    } else {
+        rem = bn_body_alloc(na + 1);
+        if (rem == NULL) return BN_NO_MEMORY;
+    }
+    memmove(rem, a->body, na * sizeof(int));
+    rem[na] = 0;
+    if (qdst != NULL) {
+        if (bn_reserve(qdst, nq)) {
+            if (rdst == NULL) bn_body_free(rem);
+            return BN_NO_MEMORY;
+        }
+        quot = qdst->body;
+    } else {
+        quot = bn_body_alloc(nq);
+        if (quot == NULL) {
+            if (rdst == NULL) bn_body_free(rem);
+            return BN_NO_MEMORY;
+        }
+    }
+    memset(quot, 0, nq * sizeof(int));
+    int const *d = b->body;
+    int db = nb < 14 ? nb : 14;
+    long long bt = 0;
+    int i, j;
+    for (j = 0; j < db; j++) {
+        bt = bt * 10 + d[nb - 1 - j];
+    }
+    for (i = na - nb; i >= 0; i--) {
+        long long rt = 0;
+        for (j = 0; j <= db; j++) {
+            rt = rt * 10 + rem[i + nb - j];
+        }
+        long long qd = rt / bt;
+        if (qd > 9) qd = 9;
+        long long borrow = 0;
+        for (j = 0; j < nb; j++) {
+            long long v = rem[i + j] - qd * d[j] - borrow;
+            borrow = 0;
+            if (v < 0) {
+                borrow = (9 - v) / 10;
+                v += borrow * 10;
             }
-            if (left->body[i] < right->body[i]) {
-                left_bigger = 0;
-                break;
+            rem[i + j] = (int)v;
+        }
+        long long top = rem[i + nb] - borrow;
+        while (top < 0) {
+            int carry = 0;
+            for (j = 0; j < nb; j++) {
+                int v = rem[i + j] + d[j] + carry;
+                carry = v >= 10;
+                rem[i + j] = v - 10 * carry;
             }
+            top += carry;
+            qd--;
         }
-        if (i == -1) {
-            ret->sign = 0;
-            ret->bodysize = 1;
-            ret->body = (int *)malloc(sizeof(int));
-            if (ret->body == NULL) {
-                free(ret);
-                return NULL;
+        rem[i + nb] = (int)top;
+        for (;;) {
+            int ge = rem[i + nb] > 0;
+            if (!ge) {
+                ge = 1;
+                for (j = nb - 1; j >= 0; j--) {
+                    if (rem[i + j] != d[j]) {
+                        ge = rem[i + j] > d[j];
+                        break;
+                    }
+                }
             }
-            ret->body[0] = 0;
-            return ret;
+            if (!ge) break;
+            int back = 0;
+            for (j = 0; j < nb; j++) {
+                int v = rem[i + j] - d[j] - back;
+                back = v < 0;
+                rem[i + j] = v + 10 * back;
+            }
+            rem[i + nb] -= back;
+            qd++;
         }
+        quot[i] = (int)qd;
     }
-    bn const *big = left_bigger?left:right;
-    bn const *small = left_bigger?right:left;
-    ret->sign = big->sign;
-    ret->body = (int *)calloc(ret->bodysize, sizeof(int));
-    if (ret->body == NULL) {
-        free(ret);
-        return NULL;
-    }
-    for (i = 0; i < ret->bodysize; i++) {
-        ret->body[i] += big->body[i];
-        if (i < small->bodysize)
-            ret->body[i] -= small->body[i];
-        if (ret->body[i] < 0) {
-            ret->body[i] += 10;
-            ret->body[i + 1]--;
+    int nr = na < nb ? na : nb;
+    if (inexact != NULL) {
+        *inexact = 0;
+        for (i = 0; i < nr; i++) {
+            if (rem[i] != 0) *inexact = 1;
         }
     }
-    if (ret->body[ret->bodysize - 1] == 0) {
-        if (bn_first_zeros(ret)) {
-            bn_delete(ret);
-            return NULL;
+    if (qdst != NULL) {
+        bn_trim(qdst, nq, 1);
+    } else if (q != NULL) {
+        bn_set_digits(q, quot, nq, 1);
+    } else {
+        bn_body_free(quot);
+    }
+    if (rdst != NULL) {
+        bn_trim(rdst, nr, 1);
+    } else if (r != NULL) {
+        bn_set_digits(r, rem, nr, 1);
+    } else {
+        bn_body_free(rem);
+    }
+    return BN_OK;
+}
+
+int bn_addmul_signed(bn *acc, bn const *a, bn const *b, int s) {
+    if (acc == NULL || acc->body == NULL || a == NULL || a->body == NULL || b == NULL || b->body == NULL) return BN_NULL_OBJECT;
+    int ps = a->sign * b->sign * s;
+    if (ps == 0) return BN_OK;
+    int base = acc->sign != 0 ? acc->sign : ps;
+    int dir = base == ps ? 1 : -1;
+    int na = a->bodysize, nb = b->bodysize, nc = acc->bodysize;
+    int const *ad = a->body, *bd = b->body;
+    int *copy = NULL;
+    if (acc == a || acc == b) {
+        copy = (int *)malloc(nc * sizeof(int));
+        if (copy == NULL) return BN_NO_MEMORY;
+        memcpy(copy, acc->body, nc * sizeof(int));
+        if (acc == a) ad = copy;
+        if (acc == b) bd = copy;
+    }
+    int n = (nc > na + nb ? nc : na + nb) + 1;
+    if (bn_body_resize(acc, n)) {
+        free(copy);
+        return BN_NO_MEMORY;
+    }
+    int *w = acc->body;
+    memset(w + nc, 0, (n - nc) * sizeof(int));
+    long long top = 0;
+    int i, j, k;
+    for (i = 0; i < na; i++) {
+        if (ad[i] == 0) continue;
+        long long m = (long long)dir * ad[i], carry = 0;
+        for (j = 0; j < nb; j++) {
+            long long v = w[i + j] + m * bd[j] + carry;
+            carry = v >= 0 ? v / 10 : -((9 - v) / 10);
+            w[i + j] = (int)(v - carry * 10);
+        }
+        for (k = i + nb; carry != 0 && k < n; k++) {
+            long long v = w[k] + carry;
+            carry = v >= 0 ? v / 10 : -((9 - v) / 10);
+            w[k] = (int)(v - carry * 10);
+        }
+        top += carry;
+    }
+    free(copy);
+    int sign = base;
+    if (top < 0) {
+        sign = -base;
+        int borrow = 0;
+        for (k = 0; k < n; k++) {
+            int v = -w[k] - borrow;
+            borrow = v < 0;
+            w[k] = v + 10 * borrow;
         }
     }
-    return ret;
+    while (n > 1 && w[n - 1] == 0) {
+        n--;
+    }
+    acc->body = w;
+    acc->bodysize = n;
+    acc->sign = (n == 1 && w[0] == 0) ? 0 : sign;
+    return BN_OK;
+}
+
+int bn_addmul(bn *acc, bn const *a, bn const *b) {
+    return bn_addmul_signed(acc, a, b, 1);
+}
+
+int bn_submul(bn *acc, bn const *a, bn const *b) {
+    return bn_addmul_signed(acc, a, b, -1);
 }
 
 bn *bn_new() {
-    bn *r = (bn *) malloc (sizeof(bn));
+    bn *r = (bn *)calloc(1, sizeof(bn));
     if (r == NULL) return NULL;
     r->bodysize = 1;
     r->sign = 0;
-    r->body = (int *)malloc(r->bodysize * sizeof(int));
+    r->body = bn_body_alloc(r->bodysize);
     if (r->body == NULL) {
         free(r);
         return NULL;
@@ -185,26 +569,28 @@ bn *bn_new() {
 
 bn *bn_init(bn const *orig) {
     if (orig == NULL) return NULL;
-    bn *r = (bn *) malloc (sizeof(bn));
+    bn *r = (bn *)calloc(1, sizeof(bn));
     if (r == NULL) return NULL;
     r->bodysize = orig->bodysize;
     r->sign = orig->sign;
-    r->body = (int *)malloc(r->bodysize * sizeof(int));
+    if (!orig->external) {
+        bn_refs_inc(&BN_HDR(orig->body)->refs);
+        r->body = orig->body;
+        return r;
+    }
+    r->body = bn_body_alloc(r->bodysize);
     if (r->body == NULL) {
         free(r);
         return NULL;
     }
-    int i;
-    for (i = 0; i < r->bodysize; i++) {
-        r->body[i] = orig->body[i];
-    }
+    memcpy(r->body, orig->body, r->bodysize * sizeof(int));
     return r;
 }
 
 int bn_init_string(bn *t, const char *init_string) {
     if (t == NULL || init_string == NULL) return BN_NULL_OBJECT;
     if (t->body != NULL) {
-        free(t->body);
+        bn_release(t);
         t->body = NULL;
     }
     int start;
@@ -221,13 +607,13 @@ int bn_init_string(bn *t, const char *init_string) {
     if (start == strlen(init_string)) {
         t->bodysize = 1;
         t->sign = 0;
-        t->body = (int *)malloc(t->bodysize * sizeof(int));
+        t->body = bn_body_alloc(t->bodysize);
         if (t->body == NULL) return BN_NO_MEMORY;
         t->body[0] = 0;
         return BN_OK;
     }
     t->bodysize = strlen(init_string) - start;
-    t->body = (int *)malloc(t->bodysize * sizeof(int));
+    t->body = bn_body_alloc(t->bodysize);
     if (t->body == NULL) return BN_NO_MEMORY;
     int i, j = 0;
     for (i = strlen(init_string) - 1; i >= start; i--) {
@@ -239,314 +625,273 @@ int bn_init_string(bn *t, const char *init_string) {
 
 int bn_init_string_radix(bn *t, const char *init_string, int radix) {
     if (t == NULL || init_string == NULL) return BN_NULL_OBJECT;
-    if (t->body != NULL) {
-        free(t->body);
-        t->body = NULL;
-    }
-    int start;
-    if (init_string[0] == '-') {
-        start = 1;
-    } else {
-        start = 0;
-    }
-    while (start < strlen(init_string) && init_string[start] == '0') {
-        start++;
-    }
+    if (radix < 2 || radix > 36) return BN_BAD_FORMAT;
+    bn_release(t);
     t->bodysize = 1;
     t->sign = 0;
-    t->body = (int *)calloc(t->bodysize, sizeof(int));
+    t->body = bn_body_alloc(t->bodysize);
     if (t->body == NULL) return BN_NO_MEMORY;
     t->body[0] = 0;
-    if (start == strlen(init_string)) {
-        return BN_OK;
-    }
-    bn *rad = (bn *)malloc(sizeof(bn));
-    if (rad == NULL) {
-        return BN_NO_MEMORY;
-    }
-    rad->sign = 1;
-    rad->bodysize = 1 + (radix >= 10);
-    rad->body = (int *)malloc(rad->bodysize * sizeof(int));
-    if (rad->body == NULL) {
-        bn_delete(rad);
-        return BN_NO_MEMORY;
-    }
-    if (radix >= 10) {
-        rad->body[0] = radix % 10;
-        rad->body[1] = radix / 10;
-    } else {
-        rad->body[0] = radix;
-    }
-    int i, digit;
-    for (i = start; i < strlen(init_string); i++) {
-        int code = bn_mul_to(t, rad);
-        if (code) {
-            bn_delete(rad);
-            return BN_NO_MEMORY;
-        };
-        if (init_string[i] >= 'A' && init_string[i] <= 'Z') {
-            digit = init_string[i] - 'A' + 10;
-            bn *addup = bn_new();
-            if (addup == NULL) {
-                bn_delete(rad);
-                return BN_NO_MEMORY;
-            }
-            if (bn_init_int(addup, digit) || bn_add_to(t, addup)) {
-                bn_delete(addup);
-                bn_delete(rad);
-                return BN_NO_MEMORY;
-            }
-            bn_delete(addup);
-        } else {
-            digit =  init_string[i] - '0';
-            bn *addup = bn_new();
-            if (addup == NULL) {
-                bn_delete(rad);
-                return BN_NO_MEMORY;
-            }
-            if (bn_init_int(addup, digit) || bn_add_to(t, addup)) {
-                bn_delete(addup);
-                bn_delete(rad);
-                return BN_NO_MEMORY;
-            }
-            bn_delete(addup);
+    int width;
+    int p = bn_radix_chunk(radix, &width);
+    int i, value = 0, n = 0, scale = 1;
+    for (i = init_string[0] == '-'; init_string[i] != '\0'; i++) {
+        int digit = bn_digit_value(init_string[i], radix);
+        if (digit < 0) return BN_BAD_FORMAT;
+        value = value * radix + digit;
+        scale *= radix;
+        if (++n == width) {
+            if (bn_mul_small_add(t, p, value)) return BN_NO_MEMORY;
+            value = 0;
+            n = 0;
+            scale = 1;
         }
     }
-    if (init_string[0] == '-') {
+    if (n > 0 && bn_mul_small_add(t, scale, value)) return BN_NO_MEMORY;
+    if (init_string[0] == '-' && t->sign != 0) {
         t->sign = -1;
     }
-    bn_delete(rad);
     return BN_OK;
 }
 
 int bn_init_int(bn *t, int init_int) {
     if (t == NULL) return BN_NULL_OBJECT;
-    if (t->body != NULL) {
-        free(t->body);
-        t->body = NULL;
-    }
-    if (init_int == 0) {
-        t->bodysize = 1;
-        t->sign = 0;
-        t->body = (int *)malloc(t->bodysize * sizeof(int));
-        if (t->body == NULL) return BN_NO_MEMORY;
-        t->body[0] = 0;
-        return BN_OK;
-    }
-    if (init_int < 0) {
-        t->sign = -1;
-        init_int = 0 - init_int;
-    } else {
-        t->sign = 1;
-    }
-    int degree = 1, s = 0;
-    while (degree <= init_int) {
-        degree *= 10;
-        s++;
-    }
-    t->bodysize = s;
-    t->body = (int *)malloc(t->bodysize * sizeof(int));
-    if (t->body == NULL) return BN_NO_MEMORY;
-    int i = 0;
-    while (init_int > 0) {
-        t->body[i] = init_int % 10;
-        init_int /= 10;
-        i++;
-    }
+    if (bn_reserve(t, 10)) return BN_NO_MEMORY;
+    unsigned int u = init_int < 0 ? 0u - (unsigned int)init_int : (unsigned int)init_int;
+    int size = 0;
+    do {
+        t->body[size++] = (int)(u % 10);
+        u /= 10;
+    } while (u > 0);
+    t->bodysize = size;
+    t->sign = init_int < 0 ? -1 : init_int > 0;
     return BN_OK;
 }
 
 int bn_delete(bn *t) {
     if (t == NULL) return;
-    free(t->body);
+    bn_release(t);
     free(t);
     return BN_OK;
 }
 
-int bn_add_to(bn *t, bn const *right) {
-    if (t == NULL || t->body == NULL || right == NULL || right->body == NULL) return BN_NULL_OBJECT;
-    bn *ret;
-    ret = bn_add(t, right);
-    if (ret == NULL) {
-        return BN_NO_MEMORY;
-    }
-    free(t->body);
-    t->sign = ret->sign;
-    t->bodysize = ret->bodysize;
-    t->body = (int *)malloc(t->bodysize * sizeof(int));
-    if (t->body == NULL) {
-        bn_delete(ret);
-        return BN_NO_MEMORY;
+int bn_addsub_into(bn *dst, bn const *a, bn const *b, int sb) {
+    int sa = a->sign;
+    sb *= b->sign;
+    if (sb == 0) return bn_assign(dst, a);
+    if (sa == 0) {
+        if (bn_assign(dst, b)) return BN_NO_MEMORY;
+        bn_uncache(dst);
+        dst->sign = sb;
+        return BN_OK;
     }
-    int i;
-    for (i = 0; i < t->bodysize; i++) {
-        t->body[i] = ret->body[i];
+    bn const *big = a, *small = b;
+    int sign = sa;
+    int c = a->bodysize - b->bodysize, i;
+    if (sa != sb) {
+        for (i = a->bodysize - 1; c == 0 && i >= 0; i--) {
+            c = a->body[i] - b->body[i];
+        }
+        if (c == 0) return bn_set_zero(dst);
+    }
+    if (c < 0) {
+        big = b;
+        small = a;
+        if (sa != sb) sign = sb;
+    }
+    int nbig = big->bodysize, nsmall = small->bodysize;
+    if (bn_body_resize(dst, nbig + 1)) return BN_NO_MEMORY;
+    int const *x = big->body, *y = small->body;
+    int *w = dst->body;
+    int carry = 0;
+    if (sa == sb) {
+        for (i = 0; i < nbig; i++) {
+            int v = x[i] + (i < nsmall ? y[i] : 0) + carry;
+            carry = v >= 10;
+            w[i] = v - 10 * carry;
+        }
+        w[nbig] = carry;
+        bn_trim(dst, nbig + 1, sign);
+    } else {
+        for (i = 0; i < nbig; i++) {
+            int v = x[i] - (i < nsmall ? y[i] : 0) - carry;
+            carry = v < 0;
+            w[i] = v + 10 * carry;
+        }
+        bn_trim(dst, nbig, sign);
     }
-    bn_delete(ret);
     return BN_OK;
 }
 
-int bn_sub_to(bn *t, bn const *right) {
-    if (t == NULL || t->body == NULL || right == NULL || right->body == NULL) return BN_NULL_OBJECT;
-    bn *ret;
-    ret = bn_sub(t, right);
-    if (ret == NULL) {
-        return BN_NO_MEMORY;
-    }
-    free(t->body);
-    t->sign = ret->sign;
-    t->bodysize = ret->bodysize;
-    t->body = (int *)malloc(t->bodysize * sizeof(int));
-    if (t->body == NULL) {
-        bn_delete(ret);
-        return BN_NO_MEMORY;
-    }
-    int i;
-    for (i = 0; i < t->bodysize; i++) {
-        t->body[i] = ret->body[i];
-    }
-    bn_delete(ret);
-    return BN_OK;
+int bn_add_into(bn *dst, bn const *a, bn const *b) {
+    if (dst == NULL || dst->body == NULL || a == NULL || a->body == NULL || b == NULL || b->body == NULL) return BN_NULL_OBJECT;
+    return bn_addsub_into(dst, a, b, 1);
 }
 
-int bn_mul_to(bn *t, bn const *right) {
-    if (t == NULL || t->body == NULL || right == NULL || right->body == NULL) return BN_NULL_OBJECT;
-    bn *ret;
-    ret = bn_mul(t, right);
-    if (ret == NULL) {
-        return BN_NO_MEMORY;
-    }
-    free(t->body);
-    t->sign = ret->sign;
-    t->bodysize = ret->bodysize;
-    t->body = (int *)malloc(t->bodysize * sizeof(int));
-    if (t->body == NULL) {
-        bn_delete(ret);
-        return BN_NO_MEMORY;
-    }
-    int i;
-    for (i = 0; i < t->bodysize; i++) {
-        t->body[i] = ret->body[i];
-    }
-    bn_delete(ret);
+int bn_sub_into(bn *dst, bn const *a, bn const *b) {
+    if (dst == NULL || dst->body == NULL || a == NULL || a->body == NULL || b == NULL || b->body == NULL) return BN_NULL_OBJECT;
+    return bn_addsub_into(dst, a, b, -1);
+}
+
+int bn_copy_into(bn *dst, bn const *src) {
+    if (dst == NULL || dst->body == NULL || src == NULL || src->body == NULL) return BN_NULL_OBJECT;
+    if (dst == src) return BN_OK;
+    if (bn_reserve(dst, src->bodysize)) return BN_NO_MEMORY;
+    memcpy(dst->body, src->body, src->bodysize * sizeof(int));
+    dst->bodysize = src->bodysize;
+    dst->sign = src->sign;
     return BN_OK;
 }
 
-int bn_div_to(bn *t, bn const *right) {
-    if (t == NULL || t->body == NULL || right == NULL || right->body == NULL) return BN_NULL_OBJECT;
-    if (right->sign == 0) return BN_DIVIDE_BY_ZERO;
-    bn *ret;
-    ret = bn_div(t, right);
-    if (ret == NULL) {
-        return BN_NO_MEMORY;
-    }
-    free(t->body);
-    t->sign = ret->sign;
-    t->bodysize = ret->bodysize;
-    t->body = (int *)malloc(t->bodysize * sizeof(int));
-    if (t->body == NULL) {
-        bn_delete(ret);
-        return BN_NO_MEMORY;
+#define BN_OOC_BLOCK 65536
+
+void bn_addmul_digits(int *w, int wn, int const *a, int na, int const *b, int nb) {
+    int i, j, k;
+    for (i = 0; i < na; i++) {
+        int m = a[i], carry = 0;
+        if (m == 0) continue;
+        for (j = 0; j < nb; j++) {
+            int v = w[i + j] + m * b[j] + carry;
+            carry = v / 10;
+            w[i + j] = v - carry * 10;
+        }
+        for (k = i + nb; carry != 0 && k < wn; k++) {
+            int v = w[k] + carry;
+            carry = v / 10;
+            w[k] = v - carry * 10;
+        }
     }
-    int i;
-    for (i = 0; i < t->bodysize; i++) {
-        t->body[i] = ret->body[i];
+}
+
+int bn_mul_blocked(bn *dst, bn const *a, bn const *b) {
+    int na = a->bodysize, nb = b->bodysize, n = na + nb + 1;
+    if (bn_reserve(dst, n)) return BN_NO_MEMORY;
+    int *w = dst->body;
+    int i, j;
+    memset(w, 0, (size_t)n * sizeof(int));
+    for (i = 0; i < na; i += BN_OOC_BLOCK) {
+        int ni = na - i < BN_OOC_BLOCK ? na - i : BN_OOC_BLOCK;
+        for (j = 0; j < nb; j += BN_OOC_BLOCK) {
+            int nj = nb - j < BN_OOC_BLOCK ? nb - j : BN_OOC_BLOCK;
+            bn_addmul_digits(w + i + j, n - i - j, a->body + i, ni, b->body + j, nj);
+            bn_evict(b, j, j + nj);
+        }
+        bn_evict(a, i, i + ni);
+        bn_evict(dst, 0, i + ni);
     }
-    bn_delete(ret);
+    bn_trim(dst, n, a->sign * b->sign);
     return BN_OK;
 }
 
-int bn_mod_to(bn *t, bn const *right) {
-    if (t == NULL || t->body == NULL || right == NULL || right->body == NULL) return BN_NULL_OBJECT;
-    if (right->sign == 0) return BN_DIVIDE_BY_ZERO;
-    bn *ret;
-    ret = bn_mod(t, right);
-    if (ret == NULL) {
-        return BN_NO_MEMORY;
-    }
-    free(t->body);
-    t->sign = ret->sign;
-    t->bodysize = ret->bodysize;
-    t->body = (int *)malloc(t->bodysize * sizeof(int));
-    if (t->body == NULL) {
-        bn_delete(ret);
-        return BN_NO_MEMORY;
-    }
-    int i;
-    for (i = 0; i < t->bodysize; i++) {
-        t->body[i] = ret->body[i];
-    }
-    bn_delete(ret);
+int bn_mul_into(bn *dst, bn const *a, bn const *b) {
+    if (dst == NULL || dst->body == NULL || a == NULL || a->body == NULL || b == NULL || b->body == NULL) return BN_NULL_OBJECT;
+    if (a->sign == 0 || b->sign == 0) return bn_set_zero(dst);
+    if (dst == a || dst == b) {
+        bn *ret = bn_new();
+        if (ret == NULL) return BN_NO_MEMORY;
+        int code = bn_mul_into(ret, a, b);
+        if (code) {
+            bn_delete(ret);
+            return code;
+        }
+        return bn_move(dst, ret);
+    }
+    if (bn_spill_wanted(a->bodysize + b->bodysize)) return bn_mul_blocked(dst, a, b);
+    if (bn_reserve(dst, a->bodysize + b->bodysize + 1)) return BN_NO_MEMORY;
+    dst->body[0] = 0;
+    dst->bodysize = 1;
+    dst->sign = 0;
+    return bn_addmul(dst, a, b);
+}
+
+int bn_div_into(bn *dst, bn const *a, bn const *b) {
+    if (dst == NULL || dst->body == NULL || a == NULL || a->body == NULL || b == NULL || b->body == NULL) return BN_NULL_OBJECT;
+    if (b->sign == 0) return BN_DIVIDE_BY_ZERO;
+    int sign = a->sign * b->sign, inexact;
+    int code = bn_divmod_abs(dst, NULL, a, b, &inexact);
+    if (code) return code;
+    if (sign < 0 && inexact && bn_mul_small_add(dst, 1, 1)) return BN_NO_MEMORY;
+    if (dst->sign != 0) dst->sign = sign;
     return BN_OK;
 }
 
-int bn_pow_to(bn *t, int degr) {
-    if (t == NULL || t->body == NULL) return BN_NULL_OBJECT;
-    int degree = degr;
-    if (degree == 0) {
-        t->bodysize = 1;
-        t->sign = 1;
-        free(t->body);
-        t->body = (int *)malloc(t->bodysize * sizeof(int));
-        if (t->body == NULL) {
-            return BN_NO_MEMORY;
+int bn_mod_into(bn *dst, bn const *a, bn const *b) {
+    if (dst == NULL || dst->body == NULL || a == NULL || a->body == NULL || b == NULL || b->body == NULL) return BN_NULL_OBJECT;
+    if (b->sign == 0) return BN_DIVIDE_BY_ZERO;
+    if (dst == b) {
+        bn *ret = bn_new();
+        if (ret == NULL) return BN_NO_MEMORY;
+        int code = bn_mod_into(ret, a, b);
+        if (code) {
+            bn_delete(ret);
+            return code;
         }
-        t->body[0] = 1;
-        return BN_OK;
-    }
+        return bn_move(dst, ret);
+    }
+    int sa = a->sign;
+    int code = bn_divmod_abs(NULL, dst, a, b, NULL);
+    if (code || dst->sign == 0) return code;
+    dst->sign = b->sign;
+    if (sa == b->sign) return BN_OK;
+    return bn_addsub_into(dst, b, dst, -1);
+}
+
+int bn_add_to(bn *t, bn const *right) {
+    return bn_add_into(t, t, right);
+}
+
+int bn_sub_to(bn *t, bn const *right) {
+    return bn_sub_into(t, t, right);
+}
+
+int bn_mul_to(bn *t, bn const *right) {
+    return bn_mul_into(t, t, right);
+}
+
+int bn_div_to(bn *t, bn const *right) {
+    return bn_div_into(t, t, right);
+}
+
+int bn_mod_to(bn *t, bn const *right) {
+    return bn_mod_into(t, t, right);
+}
+
+int bn_pow_ctl(bn *t, int degr, bn_ctl *ctl) {
+    if (t == NULL || t->body == NULL) return BN_NULL_OBJECT;
+    if (degr == 0) return bn_init_int(t, 1);
+    if (degr < 0) return BN_OK;
     bn *orig = bn_init(t);
     if (orig == NULL) {
         return BN_NO_MEMORY;
     }
-    int amount = 0, k = 1;
-    while (k < degree) {
-        k *= 2;
-        amount++;
-    }
-    amount *= 2;
-    int *action = (int *)calloc(amount, sizeof(int));
-    if (action == NULL) {
-        bn_delete(orig);
-        return BN_NO_MEMORY;
-    }
-    int i = 0;
-    while (degree > 1) {
-        if (degree % 2 == 0) {
-            action[i] = 1;
-            degree /= 2;
-        } else {
-            degree--;
-        }
-        i++;
+    int bits = 0, i, code = BN_OK;
+    while (degr >> bits > 1) {
+        bits++;
     }
-    int j;
-    k = 0;
-    for (j = i - 1; j >= 0; j--) {
-        if (action[j]) {
-            k = bn_mul_to(t, t);
-        } else {
-            k = bn_mul_to(t, orig);
-        }
-        if (k) {
-            bn_delete(orig);
-            return BN_NO_MEMORY;
-        }
+    for (i = bits - 1; code == BN_OK && i >= 0; i--) {
+        code = bn_ctl_step(ctl, (double)(bits - 1 - i) / bits);
+        if (code == BN_OK) code = bn_mul_to(t, t);
+        if (code == BN_OK && (degr >> i & 1)) code = bn_mul_to(t, orig);
     }
-    free(action);
     bn_delete(orig);
-    return BN_OK;
+    if (code == BN_OK) bn_ctl_step(ctl, 1.0);
+    return code;
+}
+
+int bn_pow_to(bn *t, int degr) {
+    return bn_pow_ctl(t, degr, NULL);
 }
 
 int bn_root_to(bn *t, int reciprocal) {
     if (t == NULL || t->body == NULL) return BN_NULL_OBJECT;
     bn *ret;
-    ret = (bn *)malloc(sizeof(bn));
+    ret = (bn *)calloc(1, sizeof(bn));
     if (ret == NULL) {
         return BN_NO_MEMORY;
     }
     ret->bodysize = (t->bodysize - 1) / reciprocal + 1;
     ret->sign = 1;
-    ret->body = (int *)calloc(ret->bodysize, sizeof(int));
+    ret->body = bn_body_calloc(ret->bodysize);
     if (ret->body == NULL) {
         bn_delete(ret);
         return BN_NO_MEMORY;
@@ -574,10 +919,10 @@ int bn_root_to(bn *t, int reciprocal) {
         }
         ret->body[i] = digit;
     }
-    free(t->body);
+    bn_release(t);
     t->sign = ret->sign;
     t->bodysize = ret->bodysize;
-    t->body = (int *)malloc(t->bodysize * sizeof(int));
+    t->body = bn_body_alloc(t->bodysize);
     if (t->body == NULL) {
         bn_delete(ret);
         return BN_NO_MEMORY;
@@ -590,385 +935,226 @@ int bn_root_to(bn *t, int reciprocal) {
 }
 
 bn* bn_add(bn const *left, bn const *right) {
-    if (left == NULL || left->body == NULL || right == NULL || right->body == NULL) return NULL;
-    bn *ret;
-    if (left->sign == right->sign) {
-        ret = bn_add_same_sign(left, right);
-    } else {
-        ret = bn_add_diff_sign(left, right);
+    bn *ret = bn_new();
+    if (ret == NULL) return NULL;
+    if (bn_add_into(ret, left, right)) {
+        bn_delete(ret);
+        return NULL;
     }
     return ret;
 }
 
 bn* bn_sub(bn const *left, bn const *right) {
-    if (left == NULL || left->body == NULL || right == NULL || right->body == NULL) return NULL;
-    bn *ret;
-    bn *minusright = bn_init(right);
-    if (minusright == NULL) {
+    bn *ret = bn_new();
+    if (ret == NULL) return NULL;
+    if (bn_sub_into(ret, left, right)) {
+        bn_delete(ret);
         return NULL;
     }
-    minusright->sign *= -1;
-    ret = bn_add(left, minusright);
-    bn_delete(minusright);
     return ret;
 }
 
 bn* bn_mul(bn const *left, bn const *right) {
-    if (left == NULL || left->body == NULL || right == NULL || right->body == NULL) return NULL;
-    bn *ret = (bn *)malloc(sizeof(bn));
-    ret->sign = left->sign * right->sign;
-    if (ret->sign == 0) {
-        ret->sign = 0;
-        ret->bodysize = 1;
-        ret->body = (int *)malloc(ret->bodysize * sizeof(int));
-        if (ret->body == NULL) {
-            free(ret);
-            return NULL;
-        }
-        ret->body[0] = 0;
-        return ret;
-    }
-    ret->bodysize = left->bodysize + right->bodysize;
-    ret->body = (int *)calloc(ret->bodysize, sizeof(int));
-    int i, j;
-    for (i = 0; i < left->bodysize; i++) {
-        for (j = 0; j < right->bodysize; j++) {
-            ret->body[i+j] += left->body[i] * right->body[j];
-            if (ret->body[i + j] > 9) {
-                ret->body[i + j + 1] += ret->body[i + j] / 10;
-                ret->body[i + j] %= 10;
-            }
-        }
-    }
-    if (ret->body[ret->bodysize - 1] == 0 && bn_first_zeros(ret)) {
+    bn *ret = bn_new();
+    if (ret == NULL) return NULL;
+    if (bn_mul_into(ret, left, right)) {
         bn_delete(ret);
         return NULL;
     }
     return ret;
 }
 
-bn* bn_div(bn const *l, bn const *r) {
-    if (l == NULL || l->body == NULL || r == NULL || r->body == NULL) return NULL;
-    if (r->sign == 0) return NULL;
-    bn *ret = (bn *)malloc(sizeof(bn));
-    if (ret == NULL) {
-        return NULL;
-    }
-    ret->bodysize = l->bodysize >= r->bodysize ? l->bodysize + 1 - r->bodysize : 1;
-    ret->body = (int *)calloc(ret->bodysize, sizeof(int));
-    if (ret->body == NULL) {
-        bn_delete(ret);
-        return NULL;
-    }
-    bn *left = bn_init(l);
-    if (left == NULL) {
-        bn_delete(ret);
-        return NULL;
-    }
-    bn_abs(left);
-    bn *right = bn_new();
-    if (right == NULL) {
-        bn_delete(ret);
-        bn_delete(right);
-        return NULL;
-    }
-    right->sign = 1;
-    int i, j;
-    for (i = ret->bodysize - 1; i >= 0; i--) {
-        free(right->body);
-        right->bodysize = i + r->bodysize;
-        right->body = (int *)calloc(right->bodysize, sizeof(int));
-        if (right->body == NULL) {
-            bn_delete(ret);
-            bn_delete(left);
-            bn_delete(right);
-            return NULL;
-        }
-        for (j = 0; j < r->bodysize; j++) {
-            right->body[i + j] = r->body[j];
-        }
-        while (bn_cmp(left, right) >= 0) {
-            ret->body[i]++;
-            if (bn_sub_to(left, right)) {
-                bn_delete(ret);
-                bn_delete(left);
-                bn_delete(right);
-                return NULL;
-            };
-        }
-    }
-    ret->sign = 1;
-    if ((left->sign != 0) && (l->sign * r->sign < 0)) {
-        bn *one = bn_new();
-        if (one == NULL) {
-            bn_delete(ret);
-            bn_delete(left);
-            bn_delete(right);
-            return NULL;
-        }
-        one->body[0] = 1;
-        one->sign = 1;
-        if (bn_add_to(ret, one)) {
-            bn_delete(one);
-            bn_delete(ret);
-            bn_delete(left);
-            bn_delete(right);
-            return NULL;
-        };
-        bn_delete(one);
-    }
-    ret->sign = l->sign * r->sign;
-    bn_delete(right);
-    bn_delete(left);
-    if (ret->body[ret->bodysize - 1] == 0 && bn_first_zeros(ret)) {
+bn* bn_div(bn const *left, bn const *right) {
+    bn *ret = bn_new();
+    if (ret == NULL) return NULL;
+    if (bn_div_into(ret, left, right)) {
         bn_delete(ret);
         return NULL;
     }
     return ret;
 }
 
-bn* bn_mod(bn const *l, bn const *r) {
-    if (l == NULL || l->body == NULL || r == NULL || r->body == NULL) return NULL;
-    if (r->sign == 0) return NULL;
-    bn *ret = (bn *)malloc(sizeof(bn));
-    if (ret == NULL) {
-        return NULL;
-    }
-    ret->bodysize = l->bodysize >= r->bodysize ? l->bodysize + 1 - r->bodysize : 1;
-    ret->body = (int *)calloc(ret->bodysize, sizeof(int));
-    if (ret->body == NULL) {
-        bn_delete(ret);
-        return NULL;
-    }
-    bn *left = bn_init(l);
-    if (left == NULL) {
-        bn_delete(ret);
-        return NULL;
-    }
-    bn_abs(left);
-    bn *right = bn_new();
-    if (right == NULL) {
+bn* bn_mod(bn const *left, bn const *right) {
+    bn *ret = bn_new();
+    if (ret == NULL) return NULL;
+    if (bn_mod_into(ret, left, right)) {
         bn_delete(ret);
-        bn_delete(right);
-        return NULL;
-    }
-    right->sign = 1;
-    int i, j;
-    for (i = ret->bodysize - 1; i >= 0; i--) {
-        free(right->body);
-        right->bodysize = i + r->bodysize;
-        right->body = (int *)calloc(right->bodysize, sizeof(int));
-        if (right->body == NULL) {
-            bn_delete(ret);
-            bn_delete(left);
-            bn_delete(right);
-            return NULL;
-        }
-        for (j = 0; j < r->bodysize; j++) {
-            right->body[i + j] = r->body[j];
-        }
-        while (bn_cmp(left, right) >= 0) {
-            ret->body[i]++;
-            if (bn_sub_to(left, right)) {
-                bn_delete(ret);
-                bn_delete(left);
-                bn_delete(right);
-                return NULL;
-            };
-        }
-    }
-    if (left->sign == 0) {
-    } else if (l->sign * r->sign >= 0) {
-        left->sign = r->sign;
-    } else {
-        if (bn_sub_to(left, right)) {
-            bn_delete(ret);
-            bn_delete(left);
-            bn_delete(right);
-            return NULL;
-        };
-        left->sign = r->sign;
-    }
-    bn_delete(right);
-    bn_delete(ret);
-    if (left->body[left->bodysize - 1] == 0 && bn_first_zeros(left)) {
-        bn_delete(left);
         return NULL;
     }
-    return left;
+    return ret;
 }
 
-bn* bn_mod_divto(bn *l, bn *r) {
-    bn *ret = (bn *)malloc(sizeof(bn));
-    if (ret == NULL) {
-        return NULL;
-    }
-    ret->bodysize = l->bodysize >= r->bodysize ? l->bodysize + 1 - r->bodysize : 1;
-    ret->body = (int *)calloc(ret->bodysize, sizeof(int));
-    if (ret->body == NULL) {
-        bn_delete(ret);
-        return NULL;
-    }
-    bn *left = bn_init(l);
-    if (left == NULL) {
-        bn_delete(ret);
-        return NULL;
-    }
-    bn_abs(left);
-    bn *right = bn_new();
-    if (right == NULL) {
-        bn_delete(ret);
-        bn_delete(right);
-        return NULL;
-    }
-    right->sign = 1;
-    int i, j;
-    for (i = ret->bodysize - 1; i >= 0; i--) {
-        free(right->body);
-        right->bodysize = i + r->bodysize;
-        right->body = (int *)calloc(right->bodysize, sizeof(int));
-        if (right->body == NULL) {
-            bn_delete(ret);
-            bn_delete(left);
-            bn_delete(right);
-            return NULL;
-        }
-        for (j = 0; j < r->bodysize; j++) {
-            right->body[i + j] = r->body[j];
-        }
-        while (bn_cmp(left, right) >= 0) {
-            ret->body[i]++;
-            if (bn_sub_to(left, right)) {
-                bn_delete(ret);
-                bn_delete(left);
-                bn_delete(right);
-                return NULL;
-            };
-        }
+int bn_divmod_digits(int *d, int *size, int m) {
+    int i, r = 0;
+    for (i = *size - 1; i >= 0; i--) {
+        r = r * 10 + d[i];
+        d[i] = r / m;
+        r %= m;
     }
-    if (left->sign == 0) {
-    } else if (l->sign * r->sign >= 0) {
-        left->sign = r->sign;
-    } else {
-        if (bn_sub_to(left, right)) {
-            bn_delete(ret);
-            bn_delete(left);
-            bn_delete(right);
-            return NULL;
-        };
-        left->sign = r->sign;
+    while (*size > 1 && d[*size - 1] == 0) {
+        (*size)--;
     }
-    if (left->body[left->bodysize - 1] == 0 && bn_first_zeros(left)) {
-        bn_delete(left);
-        bn_delete(ret);
+    return r;
+}
+
+int *bn_to_chunks(bn const *t, int radix, int *count, int *width) {
+    int p = bn_radix_chunk(radix, width);
+    int size = t->bodysize, per = 0, q;
+    for (q = p; q >= 10; q /= 10) {
+        per++;
+    }
+    int *digits = (int *)malloc(size * sizeof(int));
+    int *chunks = (int *)malloc((size / per + 2) * sizeof(int));
+    if (digits == NULL || chunks == NULL) {
+        free(digits);
+        free(chunks);
         return NULL;
     }
-    bn_first_zeros(ret);
-    free(l->body);
-    l->bodysize = ret->bodysize;
-    l->body = (int *)malloc(l->bodysize * sizeof(int));
-    for (i = 0; i < l->bodysize; i++) {
-        l->body[i] = ret->body[i];
-    }
-    if (l->bodysize == 1 && l->body[0] == 0) {
-        l->sign = 0;
-    } else {
-        l->sign = 1;
-    }
-    bn_delete(right);
-    bn_delete(ret);
-    return left;
+    memcpy(digits, t->body, size * sizeof(int));
+    *count = 0;
+    do {
+        chunks[(*count)++] = bn_divmod_digits(digits, &size, p);
+    } while (size > 1 || digits[0] != 0);
+    free(digits);
+    return chunks;
 }
 
-char *bn_to_string_ten(bn const *t) {
-    int start = 0;
-    if (t->sign == -1) start++;
-    char *ret = (char *)calloc(t->bodysize + 1 + start, sizeof(char));
-    if (ret == NULL) return NULL;
-    if (start) ret[0] = '-';
+int bn_format_chunk(char *s, int v, int radix, int width) {
+    char tmp[32];
+    int n = 0;
+    do {
+        int d = v % radix;
+        tmp[n++] = d < 10 ? '0' + d : 'A' + d - 10;
+        v /= radix;
+    } while (v > 0);
+    while (n < width) {
+        tmp[n++] = '0';
+    }
     int i;
-    for (i = start; i < t->bodysize + start ; i++) {
-        ret[i] = '0' + t->body[t->bodysize - 1 + start - i];
+    for (i = 0; i < n; i++) {
+        s[i] = tmp[n - 1 - i];
     }
-    return ret;
+    return n;
 }
 
-char *bn_to_string_radix(bn const *t, int radix) {
-    if (t->sign == 0) {
-        char *ret = (char *)calloc(2, sizeof(char));
-        ret[0] = '0';
-        return ret;
-    }
-    int size = t->bodysize;
-    if (radix >= 10) {
+#define BN_LOG_SHIFT 24
+
+static const long long bn_log_ratio[37] = {
+    0, 0, 55732706, 35163422, 27866353, 24002770, 21560354, 19852391,
+    18577569, 17581711, 16777216, 16110365, 15546245, 15061104, 14638170,
+    14265234, 13933177, 13635037, 13365398, 13119976, 12895334, 12688679,
+    12497715, 12320536, 12155543, 12001385, 11856914, 11721141, 11593217,
+    11472401, 11358050, 11249596, 11146542, 11048444, 10954912, 10865594,
+    10780177
+};
+
+size_t bn_sizeinbase(bn const *t, int radix) {
+    if (t == NULL || t->body == NULL || radix < 2 || radix > 36) return 0;
+    if (radix == 10 || t->sign == 0) return t->bodysize;
+    int k = t->bodysize < 9 ? t->bodysize : 9, i;
+    long long top = 0, p = 1;
+    for (i = 1; i <= k; i++) {
+        top = top * 10 + t->body[t->bodysize - i];
+    }
+    size_t n = 0;
+    while (p <= top) {
+        p *= radix;
+        n++;
+    }
+    long long rest = (long long)(t->bodysize - k) * bn_log_ratio[radix];
+    return n + (size_t)((rest + (1ll << BN_LOG_SHIFT) - 1) >> BN_LOG_SHIFT);
+}
+
+int bn_to_string_ctl(bn const *t, int radix, char *buf, size_t len, bn_ctl *ctl) {
+    if (t == NULL || t->body == NULL || buf == NULL) return BN_NULL_OBJECT;
+    if (radix < 2 || radix > 36) return BN_BAD_FORMAT;
+    size_t neg = t->sign == -1;
+    if (len < neg + 2) return BN_SHORT_BUFFER;
+    char *digits = buf + neg;
+    size_t room = len - neg - 1, size = 0, i;
+    if (radix == 10 || t->sign == 0) {
+        if (room < (size_t)t->bodysize) return BN_SHORT_BUFFER;
+        for (i = 0; i < (size_t)t->bodysize; i++) {
+            digits[i] = '0' + t->body[t->bodysize - 1 - i];
+        }
         size = t->bodysize;
-    } else if (radix >= 4) {
-        size = t->bodysize * 2;
-    } else if (radix == 3) {
-        size = t->bodysize * 3;
-    } else if (radix == 2) {
-        size = t->bodysize * 4;
-    }
-    char *ret = (char *)calloc(size + 2, sizeof(char));
-    int i;
-    for (i = 0; i < size + 1; i++) {
-        ret[i] = '0';
-    }
-    bn *rad = (bn *)malloc(sizeof(bn));
-    if (rad == NULL) {
-        return NULL;
-    }
-    rad->sign = 1;
-    rad->bodysize = 1 + (radix >= 10);
-    rad->body = (int *)malloc(rad->bodysize * sizeof(int));
-    if (rad->body == NULL) {
-        bn_delete(rad);
-        return NULL;
-    }
-    if (radix >= 10) {
-        rad->body[0] = radix % 10;
-        rad->body[1] = radix / 10;
     } else {
-        rad->body[0] = radix;
-    }
-    bn *orig = bn_init(t);
-    orig->sign = 1;
-    i = strlen(ret) - 1;
-    while (orig->sign > 0) {
-        bn *mod = bn_mod_divto(orig, rad);
-        if (mod->bodysize > 1) {
-            ret[i] = 'A' - 10 + 10 * mod->body[1] + mod->body[0];
-        } else {
-            ret[i] = '0' + mod->body[0];
+        int k = t->bodysize, mark = -1;
+        while (k > 0) {
+            int tick = (int)((long long)(t->bodysize - k) * 256 / t->bodysize);
+            if (tick != mark) {
+                int code = bn_ctl_step(ctl, (double)(t->bodysize - k) / t->bodysize);
+                if (code) return code;
+                mark = tick;
+            }
+            int group = k >= 9 ? 9 : k;
+            long long carry = 0, scale = 1;
+            while (group-- > 0) {
+                carry = carry * 10 + t->body[--k];
+                scale *= 10;
+            }
+            for (i = 0; i < size; i++) {
+                carry += digits[i] * scale;
+                digits[i] = (char)(carry % radix);
+                carry /= radix;
+            }
+            while (carry > 0) {
+                if (size == room) return BN_SHORT_BUFFER;
+                digits[size++] = (char)(carry % radix);
+                carry /= radix;
+            }
+        }
+        for (i = 0; i < size / 2; i++) {
+            char tmp = digits[i];
+            digits[i] = digits[size - 1 - i];
+            digits[size - 1 - i] = tmp;
+        }
+        for (i = 0; i < size; i++) {
+            digits[i] = digits[i] < 10 ? '0' + digits[i] : 'A' + digits[i] - 10;
         }
-        bn_delete(mod);
-        i--;
-    }
-    bn_delete(orig);
-    bn_delete(rad);
-    for (i = 0; i < strlen(ret); i++) {
-        if (ret[i] != '0') break;
     }
-    size = strlen(ret) - i + (t->sign == -1);
-    char *r = (char *)calloc(size + 1, sizeof(char));
-    int j;
-    for (j = i; j < strlen(ret); j++) {
-        r[j - i + (t->sign == -1)] = ret[j];
+    if (neg) buf[0] = '-';
+    digits[size] = '\0';
+    bn_ctl_step(ctl, 1.0);
+    return BN_OK;
+}
+
+#define BN_TEXT_CACHE_DIGITS 65536
+
+void bn_text_store(bn *t, int radix, const char *s) {
+    size_t len = strlen(s);
+    bn_text *text = (bn_text *)malloc(sizeof(bn_text) + len);
+    if (text == NULL) return;
+    text->radix = radix;
+    text->len = len;
+    memcpy(text->text, s, len + 1);
+    if (!bn_text_cas(&t->text, text)) free(text);
+}
+
+int bn_to_string_buf(bn const *t, int radix, char *buf, size_t len) {
+    bn *m = (bn *)t;
+    bn_text *text = m == NULL ? NULL : bn_text_get(&m->text);
+    if (text != NULL && text->radix == radix && buf != NULL) {
+        if (len < text->len + 1) return BN_SHORT_BUFFER;
+        memcpy(buf, text->text, text->len + 1);
+        return BN_OK;
     }
-    if (t->sign == -1) {
-        r[0] = '-';
+    int code = bn_to_string_ctl(t, radix, buf, len, NULL);
+    if (code == BN_OK && text == NULL && radix != 10 && t->sign != 0 && t->bodysize <= BN_TEXT_CACHE_DIGITS) {
+        bn_text_store(m, radix, buf);
     }
-    free(ret);
-    return r;
+    return code;
 }
 
 const char *bn_to_string(bn const *t, int radix) {
     if (t == NULL || t->body == NULL) return NULL;
-    char *ret;
-    if (radix == 10) {
-        ret = bn_to_string_ten(t);
-    } else {
-        ret = bn_to_string_radix(t, radix);
+    size_t len = bn_sizeinbase(t, radix) + 2;
+    if (len == 2) return NULL;
+    char *ret = (char *)malloc(len);
+    if (ret == NULL) return NULL;
+    if (bn_to_string_buf(t, radix, ret, len)) {
+        free(ret);
+        return NULL;
     }
     return ret;
 }
@@ -988,12 +1174,14 @@ int bn_cmp(bn const *left, bn const *right) {
 
 int bn_neg(bn *t) {
     if (t == NULL) return BN_NULL_OBJECT;
+    bn_uncache(t);
     t->sign *= -1;
     return BN_OK;
 }
 
 int bn_abs(bn *t) {
     if (t == NULL) return BN_NULL_OBJECT;
+    bn_uncache(t);
     t->sign = t->sign * t->sign;
     return BN_OK;
 }
@@ -1003,19 +1191,2069 @@ int bn_sign(bn const *t) {
     return t->sign;
 }
 
-bn* bn_factorial(int orig) {
-    if (orig < 1) return NULL;
-    bn *one = bn_new();
-    one->body[0] = 1;
-    one->sign = 1;
-    bn *ret = bn_init(one);
-    bn *multiplicator = bn_init(one);
+#define BN_EXPORT_MAGIC   0x454C4E42u
+#define BN_EXPORT_DIGITS  1u
+#define BN_EXPORT_PACKED  2u
+#define BN_EXPORT_HEADER  24
+#define BN_PACK_DIGITS    9
+
+struct bn_view_s {
+    bn     v;
+    void  *map;
+    size_t maplen;
+};
+
+uint32_t bn_get_le32(unsigned char const *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void bn_put_le32(unsigned char *p, uint32_t x) {
+    p[0] = (unsigned char)x;
+    p[1] = (unsigned char)(x >> 8);
+    p[2] = (unsigned char)(x >> 16);
+    p[3] = (unsigned char)(x >> 24);
+}
+
+uint32_t bn_adler32(unsigned char const *p, size_t len) {
+    uint32_t a = 1, b = 0;
+    while (len > 0) {
+        size_t n = len < 5552 ? len : 5552;
+        len -= n;
+        while (n--) {
+            a += *p++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+int bn_host_is_le32() {
+    uint32_t x = 1;
+    return sizeof(int) == 4 && *(unsigned char *)&x == 1;
+}
+
+static size_t bn_export_words(size_t size) {
+    return (size + BN_PACK_DIGITS - 1) / BN_PACK_DIGITS;
+}
+
+size_t bn_export_size(bn const *t) {
+    if (t == NULL || t->body == NULL) return 0;
+    return BN_EXPORT_HEADER + bn_export_words((size_t)t->bodysize) * 4;
+}
+
+size_t bn_export_view_size(bn const *t) {
+    if (t == NULL || t->body == NULL) return 0;
+    return BN_EXPORT_HEADER + (size_t)t->bodysize * 4;
+}
+
+void bn_export_header(unsigned char *p, bn const *t, uint32_t version, size_t n) {
+    bn_put_le32(p, BN_EXPORT_MAGIC);
+    bn_put_le32(p + 4, version);
+    bn_put_le32(p + 8, (uint32_t)t->sign);
+    bn_put_le32(p + 12, (uint32_t)t->bodysize);
+    bn_put_le32(p + 16, bn_adler32(p + BN_EXPORT_HEADER, n * 4));
+    bn_put_le32(p + 20, 0);
+}
+
+int bn_export(bn const *t, void *buf, size_t len) {
+    if (t == NULL || t->body == NULL || buf == NULL) return BN_NULL_OBJECT;
+    if (len < bn_export_size(t)) return BN_SHORT_BUFFER;
+    unsigned char *p = (unsigned char *)buf;
+    unsigned char *words = p + BN_EXPORT_HEADER;
+    int n = (int)bn_export_words((size_t)t->bodysize), i, j;
+    for (i = 0; i < n; i++) {
+        uint32_t w = 0;
+        for (j = BN_PACK_DIGITS - 1; j >= 0; j--) {
+            int k = i * BN_PACK_DIGITS + j;
+            w = w * 10 + (uint32_t)(k < t->bodysize ? t->body[k] : 0);
+        }
+        bn_put_le32(words + 4 * (size_t)i, w);
+    }
+    bn_export_header(p, t, BN_EXPORT_PACKED, (size_t)n);
+    return BN_OK;
+}
+
+int bn_export_view(bn const *t, void *buf, size_t len) {
+    if (t == NULL || t->body == NULL || buf == NULL) return BN_NULL_OBJECT;
+    if (len < bn_export_view_size(t)) return BN_SHORT_BUFFER;
+    unsigned char *p = (unsigned char *)buf;
+    unsigned char *limbs = p + BN_EXPORT_HEADER;
     int i;
-    for (i = 0; i < orig; i++) {
-        bn_mul_to(ret, multiplicator);
-        bn_add_to(multiplicator, one);
+    for (i = 0; i < t->bodysize; i++) {
+        bn_put_le32(limbs + 4 * (size_t)i, (uint32_t)t->body[i]);
     }
-    bn_delete(one);
-    bn_delete(multiplicator);
-    return ret;
+    bn_export_header(p, t, BN_EXPORT_DIGITS, (size_t)t->bodysize);
+    return BN_OK;
+}
+
+int bn_check_export(unsigned char const *p, size_t len) {
+    if (len < BN_EXPORT_HEADER || bn_get_le32(p) != BN_EXPORT_MAGIC) return BN_BAD_FORMAT;
+    uint32_t version = bn_get_le32(p + 4);
+    if (version != BN_EXPORT_DIGITS && version != BN_EXPORT_PACKED) return BN_BAD_FORMAT;
+    int sign = (int)bn_get_le32(p + 8);
+    uint32_t size = bn_get_le32(p + 12);
+    if (sign < -1 || sign > 1 || size == 0 || size > 0x7FFFFFFFu) return BN_BAD_FORMAT;
+    uint32_t n = version == BN_EXPORT_DIGITS ? size : (uint32_t)bn_export_words(size);
+    uint32_t limit = version == BN_EXPORT_DIGITS ? 9 : 999999999;
+    if ((len - BN_EXPORT_HEADER) / 4 < n) return BN_BAD_FORMAT;
+    unsigned char const *limbs = p + BN_EXPORT_HEADER;
+    if (bn_adler32(limbs, (size_t)n * 4) != bn_get_le32(p + 16)) return BN_BAD_FORMAT;
+    uint32_t i;
+    for (i = 0; i < n; i++) {
+        if (bn_get_le32(limbs + 4 * (size_t)i) > limit) return BN_BAD_FORMAT;
+    }
+    uint32_t top = bn_get_le32(limbs + 4 * (size_t)(n - 1));
+    if (version == BN_EXPORT_PACKED) {
+        uint32_t k = size - (n - 1) * BN_PACK_DIGITS;
+        while (k-- > 1) {
+            top /= 10;
+        }
+        if (top > 9) return BN_BAD_FORMAT;
+    }
+    if ((sign == 0) != (size == 1 && top == 0)) return BN_BAD_FORMAT;
+    if (size > 1 && top == 0) return BN_BAD_FORMAT;
+    return BN_OK;
+}
+
+int bn_import(bn *t, void const *buf, size_t len) {
+    if (t == NULL || buf == NULL) return BN_NULL_OBJECT;
+    unsigned char const *p = (unsigned char const *)buf;
+    int code = bn_check_export(p, len);
+    if (code) return code;
+    int size = (int)bn_get_le32(p + 12);
+    int *r = bn_body_alloc(size);
+    if (r == NULL) return BN_NO_MEMORY;
+    unsigned char const *limbs = p + BN_EXPORT_HEADER;
+    int i;
+    if (bn_get_le32(p + 4) == BN_EXPORT_DIGITS) {
+        for (i = 0; i < size; i++) {
+            r[i] = (int)bn_get_le32(limbs + 4 * (size_t)i);
+        }
+    } else {
+        uint32_t w = 0;
+        for (i = 0; i < size; i++) {
+            if (i % BN_PACK_DIGITS == 0) w = bn_get_le32(limbs + 4 * (size_t)(i / BN_PACK_DIGITS));
+            r[i] = (int)(w % 10);
+            w /= 10;
+        }
+    }
+    bn_release(t);
+    t->body = r;
+    t->bodysize = size;
+    t->sign = (int)bn_get_le32(p + 8);
+    return BN_OK;
+}
+
+bn const *bn_view_mmap(const char *path) {
+    if (path == NULL) return NULL;
+    struct bn_view_s *view = (struct bn_view_s *)calloc(1, sizeof(struct bn_view_s));
+    if (view == NULL) return NULL;
+#ifndef _WIN32
+    if (bn_host_is_le32()) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            free(view);
+            return NULL;
+        }
+        struct stat st;
+        void *map = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= BN_EXPORT_HEADER) {
+            map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (map == MAP_FAILED) {
+            free(view);
+            return NULL;
+        }
+        unsigned char const *p = (unsigned char const *)map;
+        if (bn_check_export(p, (size_t)st.st_size) == BN_OK && bn_get_le32(p + 4) == BN_EXPORT_DIGITS) {
+            view->map = map;
+            view->maplen = (size_t)st.st_size;
+            view->v.sign = (int)bn_get_le32(p + 8);
+            view->v.bodysize = (int)bn_get_le32(p + 12);
+            view->v.body = (int *)(p + BN_EXPORT_HEADER);
+            view->v.external = 1;
+            return &view->v;
+        }
+        munmap(map, (size_t)st.st_size);
+    }
+#endif
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        free(view);
+        return NULL;
+    }
+    size_t cap = 1 << 16, len = 0;
+    unsigned char *buf = (unsigned char *)malloc(cap);
+    while (buf != NULL) {
+        len += fread(buf + len, 1, cap - len, f);
+        if (len < cap) break;
+        unsigned char *grown = (unsigned char *)realloc(buf, cap * 2);
+        if (grown == NULL) {
+            free(buf);
+            buf = NULL;
+            break;
+        }
+        buf = grown;
+        cap *= 2;
+    }
+    fclose(f);
+    if (buf == NULL || bn_import(&view->v, buf, len)) {
+        free(buf);
+        bn_release(&view->v);
+        free(view);
+        return NULL;
+    }
+    free(buf);
+    return &view->v;
+}
+
+int bn_view_close(bn const *t) {
+    if (t == NULL) return BN_NULL_OBJECT;
+    struct bn_view_s *view = (struct bn_view_s *)t;
+#ifndef _WIN32
+    if (view->map != NULL) {
+        bn_uncache(&view->v);
+        munmap(view->map, view->maplen);
+        free(view);
+        return BN_OK;
+    }
+#endif
+    bn_release(&view->v);
+    free(view);
+    return BN_OK;
+}
+
+#define BN_IO_CHUNK 4096
+
+int bn_write(FILE *f, bn const *t, int radix) {
+    if (f == NULL || t == NULL || t->body == NULL) return BN_NULL_OBJECT;
+    if (radix < 2 || radix > 36) return BN_BAD_FORMAT;
+    char buf[BN_IO_CHUNK + 32];
+    int pos = 0;
+    if (t->sign == -1) {
+        buf[pos++] = '-';
+    }
+    int i;
+    if (radix == 10 || t->sign == 0) {
+        for (i = t->bodysize - 1; i >= 0; i--) {
+            buf[pos++] = '0' + t->body[i];
+            if (pos == BN_IO_CHUNK) {
+                if (fwrite(buf, 1, pos, f) != (size_t)pos) return BN_IO_ERROR;
+                pos = 0;
+            }
+        }
+    } else {
+        int count, width;
+        int *chunks = bn_to_chunks(t, radix, &count, &width);
+        if (chunks == NULL) return BN_NO_MEMORY;
+        pos += bn_format_chunk(buf + pos, chunks[count - 1], radix, 0);
+        for (i = count - 2; i >= 0; i--) {
+            pos += bn_format_chunk(buf + pos, chunks[i], radix, width);
+            if (pos >= BN_IO_CHUNK) {
+                if (fwrite(buf, 1, pos, f) != (size_t)pos) {
+                    free(chunks);
+                    return BN_IO_ERROR;
+                }
+                pos = 0;
+            }
+        }
+        free(chunks);
+    }
+    if (pos > 0 && fwrite(buf, 1, pos, f) != (size_t)pos) return BN_IO_ERROR;
+    return ferror(f) ? BN_IO_ERROR : BN_OK;
+}
+
+int bn_read(FILE *f, bn *t, int radix) {
+    if (f == NULL || t == NULL) return BN_NULL_OBJECT;
+    if (radix < 2 || radix > 36) return BN_BAD_FORMAT;
+    int c;
+    do {
+        c = getc(f);
+    } while (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+    int negative = 0;
+    if (c == '-') {
+        negative = 1;
+        c = getc(f);
+    }
+    if (bn_digit_value(c, radix) < 0) {
+        if (c != EOF) ungetc(c, f);
+        return ferror(f) ? BN_IO_ERROR : BN_BAD_FORMAT;
+    }
+    bn *r = bn_new();
+    if (r == NULL) return BN_NO_MEMORY;
+    int code = BN_OK;
+    if (radix == 10) {
+        int cap = BN_IO_CHUNK, size = 0;
+        int *digits = bn_body_alloc(cap);
+        while (digits != NULL && c != EOF && bn_digit_value(c, 10) >= 0) {
+            if (size == cap) {
+                int *grown = bn_body_realloc(digits, 2 * cap);
+                if (grown == NULL) {
+                    bn_body_free(digits);
+                    digits = NULL;
+                    break;
+                }
+                digits = grown;
+                cap *= 2;
+            }
+            digits[size++] = c - '0';
+            c = getc(f);
+        }
+        if (digits == NULL) {
+            bn_delete(r);
+            return BN_NO_MEMORY;
+        }
+        int i;
+        for (i = 0; i < size / 2; i++) {
+            int tmp = digits[i];
+            digits[i] = digits[size - 1 - i];
+            digits[size - 1 - i] = tmp;
+        }
+        bn_release(r);
+        r->body = digits;
+        r->bodysize = size;
+        r->sign = 1;
+        if (bn_first_zeros(r)) code = BN_NO_MEMORY;
+    } else {
+        int width;
+        int p = bn_radix_chunk(radix, &width);
+        int value = 0, n = 0, scale = 1, d;
+        while (c != EOF && (d = bn_digit_value(c, radix)) >= 0) {
+            value = value * radix + d;
+            scale *= radix;
+            if (++n == width) {
+                if (bn_mul_small_add(r, p, value)) {
+                    code = BN_NO_MEMORY;
+                    break;
+                }
+                value = 0;
+                n = 0;
+                scale = 1;
+            }
+            c = getc(f);
+        }
+        if (code == BN_OK && n > 0 && bn_mul_small_add(r, scale, value)) {
+            code = BN_NO_MEMORY;
+        }
+    }
+    if (c != EOF) ungetc(c, f);
+    if (code == BN_OK && ferror(f)) code = BN_IO_ERROR;
+    if (code) {
+        bn_delete(r);
+        return code;
+    }
+    if (negative && r->sign != 0) {
+        r->sign = -1;
+    }
+    bn_release(t);
+    t->body = r->body;
+    t->bodysize = r->bodysize;
+    t->sign = r->sign;
+    free(r);
+    return BN_OK;
+}
+
+bn *bn_lincomb(long long a, bn const *x, long long b, bn const *y) {
+    a *= x->sign;
+    b *= y->sign;
+    int n = (x->bodysize > y->bodysize ? x->bodysize : y->bodysize) + 18;
+    int *r = bn_body_alloc(n);
+    bn *ret = bn_new();
+    if (r == NULL || ret == NULL) {
+        bn_body_free(r);
+        bn_delete(ret);
+        return NULL;
+    }
+    long long carry = 0;
+    int k;
+    for (k = 0; k < n; k++) {
+        if (k < x->bodysize) carry += a * x->body[k];
+        if (k < y->bodysize) carry += b * y->body[k];
+        long long digit = carry % 10;
+        carry /= 10;
+        if (digit < 0) {
+            digit += 10;
+            carry--;
+        }
+        r[k] = (int)digit;
+    }
+    int sign = 1;
+    if (carry < 0) {
+        sign = -1;
+        int borrow = 0;
+        for (k = 0; k < n; k++) {
+            int v = -r[k] - borrow;
+            borrow = v < 0;
+            r[k] = v + 10 * borrow;
+        }
+    }
+    bn_set_digits(ret, r, n, sign);
+    return ret;
+}
+
+#define BN_LEHMER_DIGITS 15
+
+int bn_gcd_core(bn *g, bn *u, bn const *left, bn const *right) {
+    bn *a = bn_init(left), *b = bn_init(right);
+    bn *ua = bn_new(), *ub = bn_new();
+    bn *q = bn_new(), *r = bn_new();
+    int code = BN_OK;
+    if (a == NULL || b == NULL || ua == NULL || ub == NULL || q == NULL || r == NULL) {
+        code = BN_NO_MEMORY;
+    } else {
+        bn_abs(a);
+        bn_abs(b);
+        bn_init_int(ua, 1);
+    }
+    while (code == BN_OK && b->sign != 0) {
+        if (bn_cmp(a, b) < 0) {
+            bn *tmp = a; a = b; b = tmp;
+            tmp = ua; ua = ub; ub = tmp;
+            continue;
+        }
+        long long A = 1, B = 0, C = 0, D = 1;
+        if (a->bodysize > BN_LEHMER_DIGITS) {
+            long long ah = 0, bh = 0;
+            int k;
+            for (k = a->bodysize - 1; k >= a->bodysize - BN_LEHMER_DIGITS; k--) {
+                ah = ah * 10 + a->body[k];
+                bh = bh * 10 + (k < b->bodysize ? b->body[k] : 0);
+            }
+            while (bh + C != 0 && bh + D != 0) {
+                long long qh = (ah + A) / (bh + C);
+                if (qh != (ah + B) / (bh + D)) break;
+                long long tmp = A - qh * C; A = C; C = tmp;
+                tmp = B - qh * D; B = D; D = tmp;
+                tmp = ah - qh * bh; ah = bh; bh = tmp;
+            }
+        }
+        bn *na, *nb, *nua = NULL, *nub = NULL;
+        if (B == 0) {
+            code = bn_divmod_abs(q, r, a, b, NULL);
+            if (code) break;
+            na = bn_init(b);
+            nb = bn_init(r);
+            if (u != NULL) {
+                bn *qub = bn_mul(q, ub);
+                nua = bn_init(ub);
+                nub = qub == NULL ? NULL : bn_sub(ua, qub);
+                bn_delete(qub);
+            }
+        } else {
+            na = bn_lincomb(A, a, B, b);
+            nb = bn_lincomb(C, a, D, b);
+            if (u != NULL) {
+                nua = bn_lincomb(A, ua, B, ub);
+                nub = bn_lincomb(C, ua, D, ub);
+            }
+        }
+        bn_delete(a);
+        bn_delete(b);
+        a = na;
+        b = nb;
+        if (u != NULL) {
+            bn_delete(ua);
+            bn_delete(ub);
+            ua = nua;
+            ub = nub;
+        }
+        if (a == NULL || b == NULL || (u != NULL && (ua == NULL || ub == NULL))) {
+            code = BN_NO_MEMORY;
+        }
+    }
+    if (code == BN_OK) {
+        bn_release(g);
+        g->body = a->body;
+        g->bodysize = a->bodysize;
+        g->sign = a->sign;
+        a->body = NULL;
+        if (u != NULL) {
+            bn_release(u);
+            u->body = ua->body;
+            u->bodysize = ua->bodysize;
+            u->sign = ua->sign;
+            ua->body = NULL;
+        }
+    }
+    bn_delete(a);
+    bn_delete(b);
+    bn_delete(ua);
+    bn_delete(ub);
+    bn_delete(q);
+    bn_delete(r);
+    return code;
+}
+
+bn* bn_gcd(bn const *left, bn const *right) {
+    if (left == NULL || left->body == NULL || right == NULL || right->body == NULL) return NULL;
+    bn *ret = bn_new();
+    if (ret == NULL) return NULL;
+    if (bn_gcd_core(ret, NULL, left, right)) {
+        bn_delete(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+int bn_gcdext(bn *g, bn *s, bn *t, bn const *left, bn const *right) {
+    if (g == NULL || left == NULL || left->body == NULL || right == NULL || right->body == NULL) return BN_NULL_OBJECT;
+    bn *u = bn_new(), *v = bn_new();
+    if (u == NULL || v == NULL) {
+        bn_delete(u);
+        bn_delete(v);
+        return BN_NO_MEMORY;
+    }
+    int code = bn_gcd_core(v, u, left, right);
+    if (code == BN_OK) {
+        u->sign *= left->sign == 0 ? 1 : left->sign;
+        if (right->sign == 0) {
+            code = bn_init_int(u, left->sign);
+        }
+    }
+    if (code == BN_OK && t != NULL) {
+        bn *ul = bn_mul(u, left);
+        bn *rest = ul == NULL ? NULL : bn_sub(v, ul);
+        bn_delete(ul);
+        if (rest == NULL) {
+            code = BN_NO_MEMORY;
+        } else if (right->sign == 0) {
+            code = bn_init_int(t, 0);
+        } else {
+            code = bn_divmod_abs(t, NULL, rest, right, NULL);
+            t->sign *= rest->sign * right->sign;
+        }
+        bn_delete(rest);
+    }
+    if (code == BN_OK && s != NULL) {
+        bn_release(s);
+        s->body = u->body;
+        s->bodysize = u->bodysize;
+        s->sign = u->sign;
+        u->body = NULL;
+    }
+    if (code == BN_OK) {
+        bn_release(g);
+        g->body = v->body;
+        g->bodysize = v->bodysize;
+        g->sign = v->sign;
+        v->body = NULL;
+    }
+    bn_delete(u);
+    bn_delete(v);
+    return code;
+}
+
+int bn_mod_abs(bn *r, bn const *a, bn const *m) {
+    int code = bn_divmod_abs(NULL, r, a, m, NULL);
+    if (code || a->sign >= 0 || r->sign == 0) return code;
+    bn *ret = bn_lincomb(m->sign, m, -1, r);
+    if (ret == NULL) return BN_NO_MEMORY;
+    bn_release(r);
+    r->body = ret->body;
+    r->bodysize = ret->bodysize;
+    r->sign = ret->sign;
+    free(ret);
+    return BN_OK;
+}
+
+int bn_invert(bn *t, bn const *a, bn const *m) {
+    if (t == NULL || a == NULL || a->body == NULL || m == NULL || m->body == NULL) return BN_NULL_OBJECT;
+    if (m->sign == 0) return BN_DIVIDE_BY_ZERO;
+    bn *r = bn_new(), *g = bn_new(), *u = bn_new();
+    int code = (r == NULL || g == NULL || u == NULL) ? BN_NO_MEMORY : BN_OK;
+    if (code == BN_OK) code = bn_mod_abs(r, a, m);
+    if (code == BN_OK) code = bn_gcd_core(g, u, r, m);
+    if (code == BN_OK && !(g->bodysize == 1 && g->body[0] == 1)) code = BN_NO_INVERSE;
+    if (code == BN_OK) code = bn_mod_abs(t, u, m);
+    bn_delete(r);
+    bn_delete(g);
+    bn_delete(u);
+    return code;
+}
+
+#define BN_SHIFT_STEP 26
+
+int bn_divmod_small(bn *t, int m) {
+    if (bn_unshare(t)) return -1;
+    int r = bn_divmod_digits(t->body, &t->bodysize, m);
+    if (t->bodysize == 1 && t->body[0] == 0) {
+        t->sign = 0;
+    }
+    return r;
+}
+
+int bn_shl(bn *t, int bits) {
+    if (t == NULL || t->body == NULL) return BN_NULL_OBJECT;
+    if (bits < 0) return bn_shr(t, -bits);
+    if (t->sign == 0) return BN_OK;
+    while (bits > 0) {
+        int k = bits < BN_SHIFT_STEP ? bits : BN_SHIFT_STEP;
+        if (bn_mul_small_add(t, 1 << k, 0)) return BN_NO_MEMORY;
+        bits -= k;
+    }
+    return BN_OK;
+}
+
+int bn_shr(bn *t, int bits) {
+    if (t == NULL || t->body == NULL) return BN_NULL_OBJECT;
+    if (bits < 0) return bn_shl(t, -bits);
+    int sign = t->sign, inexact = 0;
+    while (bits > 0 && t->sign != 0) {
+        int k = bits < BN_SHIFT_STEP ? bits : BN_SHIFT_STEP;
+        int r = bn_divmod_small(t, 1 << k);
+        if (r < 0) return BN_NO_MEMORY;
+        inexact |= r != 0;
+        bits -= k;
+    }
+    if (sign < 0 && inexact) {
+        t->sign = 1;
+        if (bn_mul_small_add(t, 1, 1)) return BN_NO_MEMORY;
+        t->sign = -1;
+    }
+    return BN_OK;
+}
+
+uint32_t *bn_to_words(bn const *t, int *count) {
+    int size = t->bodysize;
+    int *digits = (int *)malloc(size * sizeof(int));
+    uint32_t *w = (uint32_t *)malloc(((size_t)size / 9 + 2) * sizeof(uint32_t));
+    if (digits == NULL || w == NULL) {
+        free(digits);
+        free(w);
+        return NULL;
+    }
+    memcpy(digits, t->body, size * sizeof(int));
+    *count = 0;
+    do {
+        long long r = 0;
+        int i;
+        for (i = size - 1; i >= 0; i--) {
+            r = r * 10 + digits[i];
+            digits[i] = (int)(r >> 32);
+            r &= 0xFFFFFFFFll;
+        }
+        while (size > 1 && digits[size - 1] == 0) {
+            size--;
+        }
+        w[(*count)++] = (uint32_t)r;
+    } while (size > 1 || digits[0] != 0);
+    free(digits);
+    return w;
+}
+
+int bn_from_words(bn *t, uint32_t const *w, int count, int sign) {
+    bn *r = bn_new();
+    if (r == NULL) return BN_NO_MEMORY;
+    int i;
+    for (i = count - 1; i >= 0; i--) {
+        if (bn_mul_small_add(r, 1 << 16, (int)(w[i] >> 16)) || bn_mul_small_add(r, 1 << 16, (int)(w[i] & 0xFFFF))) {
+            bn_delete(r);
+            return BN_NO_MEMORY;
+        }
+    }
+    bn_release(t);
+    t->body = r->body;
+    t->bodysize = r->bodysize;
+    t->sign = r->sign == 0 ? 0 : sign;
+    free(r);
+    return BN_OK;
+}
+
+void bn_twos_words(uint32_t *w, int count, int negative) {
+    if (!negative) return;
+    int i;
+    for (i = 0; i < count; i++) {
+        uint32_t old = w[i];
+        w[i] = ~(old - 1);
+        if (old != 0) {
+            for (i++; i < count; i++) {
+                w[i] = ~w[i];
+            }
+            break;
+        }
+    }
+}
+
+uint32_t bn_word_op(uint32_t a, uint32_t b, int op) {
+    if (op == '&') return a & b;
+    if (op == '|') return a | b;
+    return a ^ b;
+}
+
+bn *bn_bitwise(bn const *left, bn const *right, int op) {
+    if (left == NULL || left->body == NULL || right == NULL || right->body == NULL) return NULL;
+    int nl, nr;
+    uint32_t *wl = bn_to_words(left, &nl);
+    uint32_t *wr = bn_to_words(right, &nr);
+    int n = (nl > nr ? nl : nr) + 1;
+    uint32_t *w = (uint32_t *)malloc(n * sizeof(uint32_t));
+    bn *ret = bn_new();
+    if (wl == NULL || wr == NULL || w == NULL || ret == NULL) {
+        free(wl);
+        free(wr);
+        free(w);
+        bn_delete(ret);
+        return NULL;
+    }
+    bn_twos_words(wl, nl, left->sign < 0);
+    bn_twos_words(wr, nr, right->sign < 0);
+    uint32_t el = left->sign < 0 ? 0xFFFFFFFFu : 0, er = right->sign < 0 ? 0xFFFFFFFFu : 0;
+    int i;
+    for (i = 0; i < n; i++) {
+        uint32_t a = i < nl ? wl[i] : el;
+        uint32_t b = i < nr ? wr[i] : er;
+        w[i] = bn_word_op(a, b, op);
+    }
+    int negative = bn_word_op(el, er, op) != 0;
+    if (negative) {
+        for (i = 0; i < n; i++) {
+            w[i] = ~w[i];
+        }
+        for (i = 0; i < n && ++w[i] == 0; i++) {
+        }
+    }
+    free(wl);
+    free(wr);
+    if (bn_from_words(ret, w, n, negative ? -1 : 1)) {
+        bn_delete(ret);
+        ret = NULL;
+    }
+    free(w);
+    return ret;
+}
+
+bn* bn_and(bn const *left, bn const *right) {
+    return bn_bitwise(left, right, '&');
+}
+
+bn* bn_or(bn const *left, bn const *right) {
+    return bn_bitwise(left, right, '|');
+}
+
+bn* bn_xor(bn const *left, bn const *right) {
+    return bn_bitwise(left, right, '^');
+}
+
+int bn_not(bn *t) {
+    if (t == NULL || t->body == NULL) return BN_NULL_OBJECT;
+    bn *one = bn_new();
+    if (one == NULL) return BN_NO_MEMORY;
+    int code = bn_init_int(one, 1);
+    if (code == BN_OK) code = bn_add_to(t, one);
+    bn_delete(one);
+    if (code) return code;
+    t->sign = -t->sign;
+    return BN_OK;
+}
+
+int bn_popcount(bn const *t) {
+    if (t == NULL || t->body == NULL || t->sign < 0) return -1;
+    int count, i, bits = 0;
+    uint32_t *w = bn_to_words(t, &count);
+    if (w == NULL) return -1;
+    for (i = 0; i < count; i++) {
+        uint32_t x = w[i];
+        while (x != 0) {
+            x &= x - 1;
+            bits++;
+        }
+    }
+    free(w);
+    return bits;
+}
+
+int bn_testbit(bn const *t, int bit) {
+    if (t == NULL || t->body == NULL || bit < 0) return 0;
+    bn *q = bn_init(t);
+    if (q == NULL) return -1;
+    int ret = bn_shr(q, bit) ? -1 : q->body[0] & 1;
+    bn_delete(q);
+    return ret;
+}
+
+int bn_setbit(bn *t, int bit) {
+    if (t == NULL || t->body == NULL) return BN_NULL_OBJECT;
+    if (bit < 0) return BN_OK;
+    int set = bn_testbit(t, bit);
+    if (set) return set < 0 ? BN_NO_MEMORY : BN_OK;
+    bn *p = bn_new();
+    if (p == NULL) return BN_NO_MEMORY;
+    int code = bn_init_int(p, 1);
+    if (code == BN_OK) code = bn_shl(p, bit);
+    if (code == BN_OK) code = bn_add_to(t, p);
+    bn_delete(p);
+    return code;
+}
+
+int bn_scan1(bn const *t, int start) {
+    if (t == NULL || t->body == NULL) return -1;
+    if (start < 0) start = 0;
+    bn *q = bn_init(t);
+    if (q == NULL) return -1;
+    int ret = -1;
+    if (bn_shr(q, start) == BN_OK && q->sign != 0) {
+        ret = start;
+        for (;;) {
+            int r = bn_divmod_small(q, 1 << BN_SHIFT_STEP);
+            if (r < 0) {
+                ret = -1;
+                break;
+            }
+            if (r != 0) {
+                while ((r & 1) == 0) {
+                    r >>= 1;
+                    ret++;
+                }
+                break;
+            }
+            ret += BN_SHIFT_STEP;
+        }
+    }
+    bn_delete(q);
+    return ret;
+}
+
+#define BN_SMALL_PRIMES 168
+
+static const int bn_small_primes[BN_SMALL_PRIMES] = {
+    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71,
+    73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151,
+    157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233,
+    239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311, 313, 317,
+    331, 337, 347, 349, 353, 359, 367, 373, 379, 383, 389, 397, 401, 409, 419,
+    421, 431, 433, 439, 443, 449, 457, 461, 463, 467, 479, 487, 491, 499, 503,
+    509, 521, 523, 541, 547, 557, 563, 569, 571, 577, 587, 593, 599, 601, 607,
+    613, 617, 619, 631, 641, 643, 647, 653, 659, 661, 673, 677, 683, 691, 701,
+    709, 719, 727, 733, 739, 743, 751, 757, 761, 769, 773, 787, 797, 809, 811,
+    821, 823, 827, 829, 839, 853, 857, 859, 863, 877, 881, 883, 887, 907, 911,
+    919, 929, 937, 941, 947, 953, 967, 971, 977, 983, 991, 997
+};
+
+long long bn_mod_ll(bn const *t, long long m) {
+    long long r = 0;
+    int i;
+    for (i = t->bodysize - 1; i >= 0; i--) {
+        r = (r * 10 + t->body[i]) % m;
+    }
+    return r;
+}
+
+void bn_small_residues(bn const *t, int *res) {
+    int i = 0;
+    while (i < BN_SMALL_PRIMES) {
+        long long prod = 1;
+        int j = i;
+        while (j < BN_SMALL_PRIMES && prod * bn_small_primes[j] < 100000000000000ll) {
+            prod *= bn_small_primes[j++];
+        }
+        long long r = bn_mod_ll(t, prod);
+        for (; i < j; i++) {
+            res[i] = (int)(r % bn_small_primes[i]);
+        }
+    }
+}
+
+typedef struct {
+    bn const *mod;
+    int n, minv;
+    int *w;
+    long long *acc;
+} bn_mont;
+
+int bn_mont_init(bn_mont *M, bn const *m) {
+    int x;
+    M->mod = m;
+    M->n = m->bodysize;
+    for (x = 1; m->body[0] * x % 10 != 1; x++) {
+    }
+    M->minv = (10 - x) % 10;
+    M->w = (int *)malloc((M->n + 1) * sizeof(int));
+    M->acc = (long long *)malloc((2 * M->n + 2) * sizeof(long long));
+    if (M->w == NULL || M->acc == NULL) {
+        free(M->w);
+        free(M->acc);
+        return BN_NO_MEMORY;
+    }
+    return BN_OK;
+}
+
+void bn_mont_free(bn_mont *M) {
+    free(M->w);
+    free(M->acc);
+}
+
+int bn_mont_ge(bn_mont const *M, int const *w) {
+    int i;
+    if (w[M->n] != 0) return 1;
+    for (i = M->n - 1; i >= 0; i--) {
+        if (w[i] != M->mod->body[i]) return w[i] > M->mod->body[i];
+    }
+    return 1;
+}
+
+void bn_mont_reduce(bn_mont *M, int *r) {
+    int n = M->n, *w = M->w, i;
+    if (bn_mont_ge(M, w)) {
+        int borrow = 0;
+        for (i = 0; i < n; i++) {
+            int v = w[i] - M->mod->body[i] - borrow;
+            borrow = v < 0;
+            w[i] = v + 10 * borrow;
+        }
+    }
+    memcpy(r, w, n * sizeof(int));
+}
+
+void bn_mont_mul(bn_mont *M, int *r, int const *a, int const *b) {
+    int n = M->n, i, j;
+    int const *m = M->mod->body;
+    long long *t = M->acc;
+    memset(t, 0, (2 * n + 2) * sizeof(long long));
+    for (i = 0; i < n; i++) {
+        long long ai = a[i];
+        if (ai != 0) {
+            for (j = 0; j < n; j++) {
+                t[i + j] += ai * b[j];
+            }
+        }
+        long long u = t[i] % 10 * M->minv % 10;
+        if (u != 0) {
+            for (j = 0; j < n; j++) {
+                t[i + j] += u * m[j];
+            }
+        }
+        t[i + 1] += t[i] / 10;
+    }
+    long long carry = 0;
+    for (i = 0; i <= n; i++) {
+        carry += t[n + i];
+        M->w[i] = (int)(carry % 10);
+        carry /= 10;
+    }
+    bn_mont_reduce(M, r);
+}
+
+void bn_mont_add(bn_mont *M, int *r, int const *a, int const *b) {
+    int i, carry = 0;
+    for (i = 0; i < M->n; i++) {
+        int v = a[i] + b[i] + carry;
+        carry = v >= 10;
+        M->w[i] = v - 10 * carry;
+    }
+    M->w[M->n] = carry;
+    bn_mont_reduce(M, r);
+}
+
+void bn_mont_sub(bn_mont *M, int *r, int const *a, int const *b) {
+    int i, borrow = 0;
+    for (i = 0; i < M->n; i++) {
+        int v = a[i] - b[i] - borrow;
+        borrow = v < 0;
+        r[i] = v + 10 * borrow;
+    }
+    if (borrow) {
+        int carry = 0;
+        for (i = 0; i < M->n; i++) {
+            int v = r[i] + M->mod->body[i] + carry;
+            carry = v >= 10;
+            r[i] = v - 10 * carry;
+        }
+    }
+}
+
+void bn_mont_half(bn_mont *M, int *r, int const *a) {
+    int n = M->n, i, carry = 0;
+    int const *m = M->mod->body;
+    int odd = a[0] & 1;
+    for (i = 0; i < n; i++) {
+        int v = a[i] + (odd ? m[i] : 0) + carry;
+        carry = v >= 10;
+        M->w[i] = v - 10 * carry;
+    }
+    M->w[n] = carry;
+    int rest = 0;
+    for (i = n; i >= 0; i--) {
+        int v = rest * 10 + M->w[i];
+        M->w[i] = v / 2;
+        rest = v & 1;
+    }
+    memcpy(r, M->w, n * sizeof(int));
+}
+
+int bn_mont_from(bn_mont *M, int *r, bn const *x) {
+    int n = M->n;
+    memset(r, 0, n * sizeof(int));
+    if (x->sign == 0) return BN_OK;
+    bn *s = bn_new();
+    if (s == NULL || bn_body_resize(s, x->bodysize + n)) {
+        bn_delete(s);
+        return BN_NO_MEMORY;
+    }
+    memset(s->body, 0, n * sizeof(int));
+    memcpy(s->body + n, x->body, x->bodysize * sizeof(int));
+    s->bodysize = x->bodysize + n;
+    s->sign = 1;
+    int code = bn_divmod_abs(NULL, s, s, M->mod, NULL);
+    if (code == BN_OK && x->sign < 0 && s->sign != 0) code = bn_sub_into(s, M->mod, s);
+    if (code == BN_OK) memcpy(r, s->body, s->bodysize * sizeof(int));
+    bn_delete(s);
+    return code;
+}
+
+int bn_mont_from_ll(bn_mont *M, int *r, long long x) {
+    bn *s = bn_new();
+    if (s == NULL) return BN_NO_MEMORY;
+    int code = bn_init_ll(s, x);
+    if (code == BN_OK) code = bn_mont_from(M, r, s);
+    bn_delete(s);
+    return code;
+}
+
+int bn_mont_pow(bn_mont *M, int *r, int const *base, bn const *e) {
+    int count, i, bit;
+    uint32_t *words = bn_to_words(e, &count);
+    if (words == NULL) return BN_NO_MEMORY;
+    i = count - 1;
+    for (bit = 31; (words[i] >> bit & 1) == 0; bit--) {
+    }
+    memcpy(r, base, M->n * sizeof(int));
+    for (bit--; i >= 0; i--, bit = 31) {
+        for (; bit >= 0; bit--) {
+            bn_mont_mul(M, r, r, r);
+            if (words[i] >> bit & 1) bn_mont_mul(M, r, r, base);
+        }
+    }
+    free(words);
+    return BN_OK;
+}
+
+int bn_mont_is(bn_mont const *M, int const *a, int const *b) {
+    return memcmp(a, b, M->n * sizeof(int)) == 0;
+}
+
+int bn_mont_is_zero(bn_mont const *M, int const *a) {
+    int i;
+    for (i = 0; i < M->n; i++) {
+        if (a[i] != 0) return 0;
+    }
+    return 1;
+}
+
+int bn_jacobi_small(long long a, long long n) {
+    int j = 1;
+    a %= n;
+    while (a != 0) {
+        while (a % 2 == 0) {
+            a /= 2;
+            if (n % 8 == 3 || n % 8 == 5) j = -j;
+        }
+        long long t = a;
+        a = n;
+        n = t;
+        if (a % 4 == 3 && n % 4 == 3) j = -j;
+        a %= n;
+    }
+    return n == 1 ? j : 0;
+}
+
+int bn_jacobi_ll(long long d, bn const *n) {
+    long long ad = d < 0 ? -d : d;
+    int n4 = (int)bn_mod_ll(n, 4);
+    int j = bn_jacobi_small(bn_mod_ll(n, ad), ad);
+    if (d < 0 && n4 == 3) j = -j;
+    if (ad % 4 == 3 && n4 == 3) j = -j;
+    return j;
+}
+
+int bn_is_square(bn const *t) {
+    bn *r = bn_init(t);
+    if (r == NULL) return -1;
+    int ret = -1;
+    if (bn_root_to(r, 2) == BN_OK && bn_mul_to(r, r) == BN_OK) {
+        ret = bn_cmp(r, t) == 0;
+    }
+    bn_delete(r);
+    return ret;
+}
+
+int bn_miller_rabin(bn_mont *M, int *x, int const *a, int const *one, int const *mone, bn const *d, int s) {
+    if (bn_mont_pow(M, x, a, d)) return -1;
+    if (bn_mont_is(M, x, one) || bn_mont_is(M, x, mone)) return 1;
+    while (--s > 0) {
+        bn_mont_mul(M, x, x, x);
+        if (bn_mont_is(M, x, mone)) return 1;
+    }
+    return 0;
+}
+
+int bn_lucas_strong(bn_mont *M, int *buf, bn const *n, long long d) {
+    int size = M->n;
+    int *u = buf, *v = buf + size, *qk = buf + 2 * size;
+    int *qm = buf + 3 * size, *dm = buf + 4 * size, *tmp = buf + 5 * size;
+    bn *e = bn_init(n);
+    if (e == NULL || bn_mul_small_add(e, 1, 1)) {
+        bn_delete(e);
+        return -1;
+    }
+    int s = bn_scan1(e, 0);
+    if (s < 0 || bn_shr(e, s)) {
+        bn_delete(e);
+        return -1;
+    }
+    int count, i, bit;
+    uint32_t *words = bn_to_words(e, &count);
+    bn_delete(e);
+    if (words == NULL) return -1;
+    if (bn_mont_from_ll(M, qm, (1 - d) / 4) || bn_mont_from_ll(M, dm, d) || bn_mont_from_ll(M, u, 1)) {
+        free(words);
+        return -1;
+    }
+    memcpy(v, u, size * sizeof(int));
+    memcpy(qk, qm, size * sizeof(int));
+    i = count - 1;
+    for (bit = 31; (words[i] >> bit & 1) == 0; bit--) {
+    }
+    for (bit--; i >= 0; i--, bit = 31) {
+        for (; bit >= 0; bit--) {
+            bn_mont_mul(M, u, u, v);
+            bn_mont_mul(M, v, v, v);
+            bn_mont_sub(M, v, v, qk);
+            bn_mont_sub(M, v, v, qk);
+            bn_mont_mul(M, qk, qk, qk);
+            if (words[i] >> bit & 1) {
+                bn_mont_mul(M, tmp, dm, u);
+                bn_mont_add(M, u, u, v);
+                bn_mont_half(M, u, u);
+                bn_mont_add(M, v, tmp, v);
+                bn_mont_half(M, v, v);
+                bn_mont_mul(M, qk, qk, qm);
+            }
+        }
+    }
+    free(words);
+    if (bn_mont_is_zero(M, u) || bn_mont_is_zero(M, v)) return 1;
+    while (--s > 0) {
+        bn_mont_mul(M, v, v, v);
+        bn_mont_sub(M, v, v, qk);
+        bn_mont_sub(M, v, v, qk);
+        if (bn_mont_is_zero(M, v)) return 1;
+        bn_mont_mul(M, qk, qk, qk);
+    }
+    return 0;
+}
+
+int bn_bpsw(bn_mont *M, int *buf, bn const *n, bn const *d, int s, int reps) {
+    int size = M->n;
+    int *one = buf, *mone = buf + size, *a = buf + 2 * size, *x = buf + 3 * size;
+    if (bn_mont_from_ll(M, one, 1) || bn_mont_from_ll(M, mone, -1) || bn_mont_from_ll(M, a, 2)) return -1;
+    int ret = bn_miller_rabin(M, x, a, one, mone, d, s);
+    if (ret != 1) return ret;
+    long long dd = 5;
+    int tries = 0, j;
+    while ((j = bn_jacobi_ll(dd, n)) != -1) {
+        if (j == 0) return 0;
+        dd = dd > 0 ? -(dd + 2) : -dd + 2;
+        if (++tries == 10) {
+            ret = bn_is_square(n);
+            if (ret != 0) return ret < 0 ? -1 : 0;
+        }
+    }
+    ret = bn_lucas_strong(M, x, n, dd);
+    int k;
+    for (k = 1; ret == 1 && k <= reps && k < BN_SMALL_PRIMES; k++) {
+        if (bn_mont_from_ll(M, a, bn_small_primes[k])) return -1;
+        ret = bn_miller_rabin(M, x, a, one, mone, d, s);
+    }
+    return ret;
+}
+
+int bn_prime_test(bn const *n, int reps) {
+    bn_mont M;
+    if (bn_mont_init(&M, n)) return -1;
+    int *buf = (int *)malloc(9 * n->bodysize * sizeof(int));
+    bn *d = bn_init(n);
+    int ret = -1;
+    if (buf != NULL && d != NULL && bn_unshare(d) == BN_OK) {
+        d->body[0]--;
+        int s = bn_scan1(d, 0);
+        if (s >= 0 && bn_shr(d, s) == BN_OK) ret = bn_bpsw(&M, buf, n, d, s, reps);
+    }
+    bn_mont_free(&M);
+    free(buf);
+    bn_delete(d);
+    return ret;
+}
+
+int bn_probab_prime(bn const *t, int reps) {
+    if (t == NULL || t->body == NULL) return -1;
+    int i;
+    if (t->bodysize <= 6) {
+        int v = 0;
+        for (i = t->bodysize - 1; i >= 0; i--) {
+            v = v * 10 + t->body[i];
+        }
+        if (v < 2) return 0;
+        for (i = 0; i < BN_SMALL_PRIMES && bn_small_primes[i] * bn_small_primes[i] <= v; i++) {
+            if (v % bn_small_primes[i] == 0) return 0;
+        }
+        return 2;
+    }
+    int res[BN_SMALL_PRIMES];
+    bn_small_residues(t, res);
+    for (i = 0; i < BN_SMALL_PRIMES; i++) {
+        if (res[i] == 0) return 0;
+    }
+    bn *n = bn_init(t);
+    if (n == NULL) return -1;
+    n->sign = 1;
+    int ret = bn_prime_test(n, reps);
+    bn_delete(n);
+    return ret;
+}
+
+int bn_nextprime(bn *t, bn const *orig) {
+    if (t == NULL || t->body == NULL || orig == NULL || orig->body == NULL) return BN_NULL_OBJECT;
+    if (orig->sign <= 0 || (orig->bodysize == 1 && orig->body[0] < 2)) return bn_init_int(t, 2);
+    if (bn_assign(t, orig)) return BN_NO_MEMORY;
+    if (bn_mul_small_add(t, 1, t->body[0] % 2 ? 2 : 1)) return BN_NO_MEMORY;
+    int res[BN_SMALL_PRIMES], delta = 0, i;
+    bn_small_residues(t, res);
+    for (;;) {
+        int sieved = 1;
+        for (i = 1; sieved && i < BN_SMALL_PRIMES; i++) {
+            sieved = res[i] != 0;
+        }
+        if (sieved || t->bodysize <= 6) {
+            if (bn_mul_small_add(t, 1, delta)) return BN_NO_MEMORY;
+            delta = 0;
+            int r = bn_probab_prime(t, 0);
+            if (r < 0) return BN_NO_MEMORY;
+            if (r > 0) return BN_OK;
+        }
+        delta += 2;
+        for (i = 1; i < BN_SMALL_PRIMES; i++) {
+            res[i] = (res[i] + 2) % bn_small_primes[i];
+        }
+    }
+}
+
+#ifdef _OPENMP
+#define BN_OMP_FOR _Pragma("omp parallel for reduction(max: code)")
+#else
+#define BN_OMP_FOR
+#endif
+
+int bn_tree_level(bn **dst, bn * const *src, int n) {
+    int half = n / 2, j, code = BN_OK;
+    BN_OMP_FOR
+    for (j = 0; j < half; j++) {
+        dst[j] = bn_new();
+        int c = dst[j] == NULL ? BN_NO_MEMORY : bn_mul_into(dst[j], src[2 * j], src[2 * j + 1]);
+        if (c > code) code = c;
+    }
+    if (n % 2 != 0) {
+        dst[half] = bn_init(src[n - 1]);
+        if (dst[half] == NULL) code = BN_NO_MEMORY;
+    }
+    return code;
+}
+
+void bn_tree_free(bn **v, int n) {
+    int i;
+    if (v == NULL) return;
+    for (i = 0; i < n; i++) {
+        bn_delete(v[i]);
+    }
+    free(v);
+}
+
+int bn_tree_depth(int n) {
+    int depth = 1;
+    while (n > 1) {
+        n = (n + 1) / 2;
+        depth++;
+    }
+    return depth;
+}
+
+void bn_tree_free_all(bn ***tree, int count) {
+    int k, n = count, depth = bn_tree_depth(count);
+    for (k = 0; k < depth; k++) {
+        bn_tree_free(tree[k], n);
+        n = (n + 1) / 2;
+    }
+    free(tree);
+}
+
+bn ***bn_tree_build(bn * const *v, int count) {
+    int depth = bn_tree_depth(count), k, i, n = count;
+    bn ***tree = (bn ***)calloc(depth, sizeof(bn **));
+    if (tree == NULL) return NULL;
+    int code = BN_OK;
+    tree[0] = (bn **)calloc(count, sizeof(bn *));
+    if (tree[0] == NULL) code = BN_NO_MEMORY;
+    for (i = 0; code == BN_OK && i < count; i++) {
+        tree[0][i] = bn_init(v[i]);
+        if (tree[0][i] == NULL) {
+            code = BN_NO_MEMORY;
+        } else {
+            tree[0][i]->sign *= tree[0][i]->sign;
+        }
+    }
+    for (k = 1; code == BN_OK && k < depth; k++) {
+        tree[k] = (bn **)calloc((n + 1) / 2, sizeof(bn *));
+        code = tree[k] == NULL ? BN_NO_MEMORY : bn_tree_level(tree[k], tree[k - 1], n);
+        n = (n + 1) / 2;
+    }
+    if (code != BN_OK) {
+        bn_tree_free_all(tree, count);
+        return NULL;
+    }
+    return tree;
+}
+
+int bn_prod_tree(bn *t, bn * const *v, int count) {
+    if (t == NULL || t->body == NULL || (count > 0 && v == NULL)) return BN_NULL_OBJECT;
+    int i;
+    for (i = 0; i < count; i++) {
+        if (v[i] == NULL || v[i]->body == NULL) return BN_NULL_OBJECT;
+    }
+    if (count == 0) return bn_init_int(t, 1);
+    bn **cur = (bn **)calloc(count, sizeof(bn *));
+    if (cur == NULL) return BN_NO_MEMORY;
+    int n = count, code = bn_tree_level(cur, v, n);
+    n = (n + 1) / 2;
+    while (code == BN_OK && n > 1) {
+        bn **next = (bn **)calloc((n + 1) / 2, sizeof(bn *));
+        code = next == NULL ? BN_NO_MEMORY : bn_tree_level(next, cur, n);
+        bn_tree_free(cur, n);
+        cur = next;
+        n = (n + 1) / 2;
+    }
+    if (code == BN_OK) code = bn_assign(t, cur[0]);
+    bn_tree_free(cur, n);
+    return code;
+}
+
+int bn_check_moduli(bn * const *m, int count) {
+    int i;
+    if (count > 0 && m == NULL) return BN_NULL_OBJECT;
+    for (i = 0; i < count; i++) {
+        if (m[i] == NULL || m[i]->body == NULL) return BN_NULL_OBJECT;
+        if (m[i]->sign == 0) return BN_DIVIDE_BY_ZERO;
+    }
+    return BN_OK;
+}
+
+int bn_multi_mod(bn * const *res, bn const *t, bn * const *m, int count) {
+    if (res == NULL || t == NULL || t->body == NULL) return BN_NULL_OBJECT;
+    int code = bn_check_moduli(m, count), i, j, k;
+    for (i = 0; code == BN_OK && i < count; i++) {
+        if (res[i] == NULL || res[i]->body == NULL) code = BN_NULL_OBJECT;
+    }
+    if (code != BN_OK || count == 0) return code;
+    bn ***tree = bn_tree_build(m, count);
+    if (tree == NULL) return BN_NO_MEMORY;
+    int depth = bn_tree_depth(count);
+    bn **up = (bn **)calloc(1, sizeof(bn *));
+    if (up == NULL || (up[0] = bn_init(t)) == NULL) code = BN_NO_MEMORY;
+    int n = 1;
+    for (k = depth - 1; code == BN_OK && k >= 0; k--) {
+        int size = count;
+        for (j = 0; j < k; j++) {
+            size = (size + 1) / 2;
+        }
+        bn **down = (bn **)calloc(size, sizeof(bn *));
+        if (down == NULL) {
+            code = BN_NO_MEMORY;
+            break;
+        }
+        BN_OMP_FOR
+        for (j = 0; j < size; j++) {
+            down[j] = bn_new();
+            int c = down[j] == NULL ? BN_NO_MEMORY : bn_mod_into(down[j], up[j / 2], tree[k][j]);
+            if (c > code) code = c;
+        }
+        bn_tree_free(up, n);
+        up = down;
+        n = size;
+    }
+    if (code == BN_OK) {
+        BN_OMP_FOR
+        for (i = 0; i < count; i++) {
+            int c = bn_mod_into(res[i], up[i], m[i]);
+            if (c > code) code = c;
+        }
+    }
+    bn_tree_free(up, n);
+    bn_tree_free_all(tree, count);
+    return code;
+}
+
+int bn_crt_pair(bn *x, bn const *x1, bn const *m1, bn const *x2, bn const *m2) {
+    bn *d = bn_new(), *u = bn_new();
+    int code = (d == NULL || u == NULL) ? BN_NO_MEMORY : bn_invert(u, m1, m2);
+    if (code == BN_OK) code = bn_sub_into(d, x2, x1);
+    if (code == BN_OK) code = bn_mul_into(d, d, u);
+    if (code == BN_OK) code = bn_mod_into(d, d, m2);
+    if (code == BN_OK) code = bn_mul_into(d, d, m1);
+    if (code == BN_OK) code = bn_add_into(x, x1, d);
+    bn_delete(d);
+    bn_delete(u);
+    return code;
+}
+
+int bn_crt(bn *t, bn * const *r, bn * const *m, int count) {
+    if (t == NULL || t->body == NULL || (count > 0 && r == NULL)) return BN_NULL_OBJECT;
+    int code = bn_check_moduli(m, count), i, j, k;
+    for (i = 0; code == BN_OK && i < count; i++) {
+        if (r[i] == NULL || r[i]->body == NULL) code = BN_NULL_OBJECT;
+    }
+    if (code != BN_OK) return code;
+    if (count == 0) return bn_set_zero(t);
+    bn ***tree = bn_tree_build(m, count);
+    if (tree == NULL) return BN_NO_MEMORY;
+    int depth = bn_tree_depth(count), n = count;
+    bn **cur = (bn **)calloc(count, sizeof(bn *));
+    if (cur == NULL) {
+        bn_tree_free_all(tree, count);
+        return BN_NO_MEMORY;
+    }
+    BN_OMP_FOR
+    for (i = 0; i < count; i++) {
+        cur[i] = bn_new();
+        int c = cur[i] == NULL ? BN_NO_MEMORY : bn_mod_into(cur[i], r[i], tree[0][i]);
+        if (c > code) code = c;
+    }
+    for (k = 0; code == BN_OK && k + 1 < depth; k++) {
+        int half = n / 2;
+        bn **next = (bn **)calloc((n + 1) / 2, sizeof(bn *));
+        if (next == NULL) {
+            code = BN_NO_MEMORY;
+            break;
+        }
+        BN_OMP_FOR
+        for (j = 0; j < half; j++) {
+            next[j] = bn_new();
+            int c = next[j] == NULL ? BN_NO_MEMORY
+                : bn_crt_pair(next[j], cur[2 * j], tree[k][2 * j], cur[2 * j + 1], tree[k][2 * j + 1]);
+            if (c > code) code = c;
+        }
+        if (n % 2 != 0) {
+            next[half] = bn_init(cur[n - 1]);
+            if (next[half] == NULL) code = BN_NO_MEMORY;
+        }
+        bn_tree_free(cur, n);
+        cur = next;
+        n = (n + 1) / 2;
+    }
+    if (code == BN_OK) code = bn_assign(t, cur[0]);
+    bn_tree_free(cur, n);
+    bn_tree_free_all(tree, count);
+    return code;
+}
+
+long long bn_factorial_leaf(int *i, int n) {
+    long long prod = 1;
+    while (*i <= n && prod <= 100000000000000000ll / *i) {
+        prod *= (*i)++;
+    }
+    return prod;
+}
+
+int bn_factorial_ctl(bn *t, int n, bn_ctl *ctl) {
+    if (t == NULL || t->body == NULL) return BN_NULL_OBJECT;
+    if (n < 2) return bn_init_int(t, 1);
+    int leaves = 0, count = 0, i = 2, code = BN_OK;
+    while (i <= n) {
+        bn_factorial_leaf(&i, n);
+        leaves++;
+    }
+    bn **cur = (bn **)calloc(leaves, sizeof(bn *));
+    if (cur == NULL) return BN_NO_MEMORY;
+    i = 2;
+    while (code == BN_OK && i <= n) {
+        long long prod = bn_factorial_leaf(&i, n);
+        cur[count] = bn_new();
+        code = cur[count] == NULL ? BN_NO_MEMORY : bn_init_ll(cur[count], prod);
+        count++;
+    }
+    int depth = bn_tree_depth(count), k;
+    for (k = 1; code == BN_OK && count > 1; k++) {
+        code = bn_ctl_step(ctl, (double)k / depth);
+        if (code != BN_OK) break;
+        bn **next = (bn **)calloc((count + 1) / 2, sizeof(bn *));
+        code = next == NULL ? BN_NO_MEMORY : bn_tree_level(next, cur, count);
+        bn_tree_free(cur, count);
+        cur = next;
+        count = (count + 1) / 2;
+    }
+    if (code == BN_OK) code = bn_assign(t, cur[0]);
+    bn_tree_free(cur, count);
+    if (code == BN_OK) bn_ctl_step(ctl, 1.0);
+    return code;
+}
+
+bn* bn_factorial(int orig) {
+    if (orig < 1) return NULL;
+    bn *ret = bn_new();
+    if (ret == NULL) return NULL;
+    if (bn_factorial_ctl(ret, orig, NULL)) {
+        bn_delete(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+int bn_fib_pair(bn *f, bn *g, int n) {
+    bn *a = bn_new(), *b = bn_new(), *two = bn_new();
+    int code = (a == NULL || b == NULL || two == NULL) ? BN_NO_MEMORY : BN_OK;
+    if (code == BN_OK) code = bn_init_int(f, 1);
+    if (code == BN_OK) code = bn_init_int(g, 0);
+    int bit = 30, odd = 1;
+    while (bit >= 0 && (n >> bit & 1) == 0) {
+        bit--;
+    }
+    for (bit--; code == BN_OK && bit >= 0; bit--) {
+        code = bn_mul_into(a, f, f);
+        if (code == BN_OK) code = bn_mul_into(b, g, g);
+        if (code == BN_OK) code = bn_init_int(two, odd ? -2 : 2);
+        if (code == BN_OK) code = bn_assign(f, a);
+        if (code == BN_OK) code = bn_mul_small_add(f, 4, 0);
+        if (code == BN_OK) code = bn_sub_into(f, f, b);
+        if (code == BN_OK) code = bn_add_into(f, f, two);
+        if (code == BN_OK) code = bn_add_into(g, a, b);
+        if (n >> bit & 1) {
+            if (code == BN_OK) code = bn_sub_into(g, f, g);
+        } else {
+            if (code == BN_OK) code = bn_sub_into(f, f, g);
+        }
+        odd = n >> bit & 1;
+    }
+    bn_delete(a);
+    bn_delete(b);
+    bn_delete(two);
+    return code;
+}
+
+bn* bn_fib(int n) {
+    if (n < 0) return NULL;
+    bn *f = bn_new(), *g = bn_new();
+    int code = (f == NULL || g == NULL) ? BN_NO_MEMORY : BN_OK;
+    if (code == BN_OK) code = n == 0 ? bn_set_zero(f) : bn_fib_pair(f, g, n);
+    bn_delete(g);
+    if (code != BN_OK) {
+        bn_delete(f);
+        return NULL;
+    }
+    return f;
+}
+
+bn* bn_lucas(int n) {
+    if (n < 0) return NULL;
+    bn *f = bn_new(), *g = bn_new();
+    int code = (f == NULL || g == NULL) ? BN_NO_MEMORY : BN_OK;
+    if (code == BN_OK && n == 0) {
+        code = bn_init_int(f, 2);
+    } else if (code == BN_OK) {
+        code = bn_fib_pair(f, g, n);
+        if (code == BN_OK) code = bn_add_into(f, f, g);
+        if (code == BN_OK) code = bn_add_into(f, f, g);
+    }
+    bn_delete(g);
+    if (code != BN_OK) {
+        bn_delete(f);
+        return NULL;
+    }
+    return f;
+}
+
+char *bn_sieve(int n) {
+    char *composite = (char *)calloc((size_t)n + 1, 1);
+    if (composite == NULL) return NULL;
+    long long i, j;
+    for (i = 2; i * i <= n; i++) {
+        if (composite[i]) continue;
+        for (j = i * i; j <= n; j += i) {
+            composite[j] = 1;
+        }
+    }
+    return composite;
+}
+
+int bn_prod_ints(bn *t, int const *v, int count) {
+    bn **leaf = (bn **)calloc(count + 1, sizeof(bn *));
+    if (leaf == NULL) return BN_NO_MEMORY;
+    int n = 0, i = 0, code = BN_OK;
+    while (code == BN_OK && i < count) {
+        long long prod = 1;
+        while (i < count && prod <= 100000000000000000ll / v[i]) {
+            prod *= v[i++];
+        }
+        leaf[n] = bn_new();
+        code = leaf[n] == NULL ? BN_NO_MEMORY : bn_init_ll(leaf[n], prod);
+        n++;
+    }
+    if (code == BN_OK) code = bn_prod_tree(t, leaf, n);
+    bn_tree_free(leaf, n);
+    return code;
+}
+
+bn* bn_binomial(int n, int k) {
+    if (n < 0) return NULL;
+    bn *ret = bn_new();
+    if (ret == NULL) return NULL;
+    if (k < 0 || k > n) return ret;
+    if (k > n - k) k = n - k;
+    char *composite = bn_sieve(n);
+    int *factors = (int *)malloc(((size_t)n / 2 + 2) * sizeof(int));
+    int count = 0, p, code = BN_OK;
+    if (composite == NULL || factors == NULL) code = BN_NO_MEMORY;
+    for (p = 2; code == BN_OK && p <= n; p++) {
+        if (composite[p]) continue;
+        long long q = p, f = 1;
+        while (q <= n) {
+            if (n / q - k / q - (n - k) / q != 0) f *= p;
+            q *= p;
+        }
+        if (f > 1) factors[count++] = (int)f;
+    }
+    if (code == BN_OK) code = bn_prod_ints(ret, factors, count);
+    free(composite);
+    free(factors);
+    if (code != BN_OK) {
+        bn_delete(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+bn* bn_primorial(int n) {
+    if (n < 0) return NULL;
+    bn *ret = bn_new();
+    if (ret == NULL) return NULL;
+    char *composite = bn_sieve(n > 1 ? n : 1);
+    int *factors = (int *)malloc(((size_t)n / 2 + 2) * sizeof(int));
+    int count = 0, p, code = BN_OK;
+    if (composite == NULL || factors == NULL) code = BN_NO_MEMORY;
+    for (p = 2; code == BN_OK && p <= n; p++) {
+        if (!composite[p]) factors[count++] = p;
+    }
+    if (code == BN_OK) code = bn_prod_ints(ret, factors, count);
+    free(composite);
+    free(factors);
+    if (code != BN_OK) {
+        bn_delete(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+enum bn_job_kinds {
+    BN_JOB_FACTORIAL, BN_JOB_POW, BN_JOB_STRING
+};
+
+struct bn_job_s {
+    int kind;
+    int n;
+    bn *value;
+    char *text;
+    long cancel;
+    int done;
+    int code;
+    bn_ctl ctl;
+    struct bn_job_s *next;
+};
+
+void bn_job_run(bn_job *job) {
+    int code = bn_ctl_step(&job->ctl, 0.0);
+    if (code == BN_OK && job->kind == BN_JOB_FACTORIAL) {
+        code = bn_factorial_ctl(job->value, job->n, &job->ctl);
+    } else if (code == BN_OK && job->kind == BN_JOB_POW) {
+        code = bn_pow_ctl(job->value, job->n, &job->ctl);
+    } else if (code == BN_OK) {
+        size_t len = bn_sizeinbase(job->value, job->n) + 2;
+        job->text = (char *)malloc(len);
+        code = job->text == NULL ? BN_NO_MEMORY : bn_to_string_ctl(job->value, job->n, job->text, len, &job->ctl);
+        if (code != BN_OK) {
+            free(job->text);
+            job->text = NULL;
+        }
+    }
+    job->code = code;
+}
+
+#ifndef _WIN32
+#include <pthread.h>
+
+#define BN_MAX_WORKERS 64
+
+static pthread_once_t bn_pool_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t bn_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bn_pool_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t bn_pool_done = PTHREAD_COND_INITIALIZER;
+static bn_job *bn_pool_head, *bn_pool_tail;
+static int bn_pool_workers;
+
+void *bn_pool_worker(void *unused) {
+    (void)unused;
+    for (;;) {
+        pthread_mutex_lock(&bn_pool_lock);
+        while (bn_pool_head == NULL) {
+            pthread_cond_wait(&bn_pool_wake, &bn_pool_lock);
+        }
+        bn_job *job = bn_pool_head;
+        bn_pool_head = job->next;
+        if (bn_pool_head == NULL) bn_pool_tail = NULL;
+        pthread_mutex_unlock(&bn_pool_lock);
+        bn_job_run(job);
+        pthread_mutex_lock(&bn_pool_lock);
+        job->done = 1;
+        pthread_cond_broadcast(&bn_pool_done);
+        pthread_mutex_unlock(&bn_pool_lock);
+    }
+    return NULL;
+}
+
+void bn_pool_start() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > BN_MAX_WORKERS) n = BN_MAX_WORKERS;
+    for (; bn_pool_workers < n; bn_pool_workers++) {
+        pthread_t id;
+        if (pthread_create(&id, NULL, bn_pool_worker, NULL) != 0) break;
+        pthread_detach(id);
+    }
+}
+
+bn_job *bn_job_submit(bn_job *job) {
+    pthread_once(&bn_pool_once, bn_pool_start);
+    if (bn_pool_workers == 0) {
+        bn_job_run(job);
+        job->done = 1;
+        return job;
+    }
+    pthread_mutex_lock(&bn_pool_lock);
+    if (bn_pool_tail != NULL) {
+        bn_pool_tail->next = job;
+    } else {
+        bn_pool_head = job;
+    }
+    bn_pool_tail = job;
+    pthread_cond_signal(&bn_pool_wake);
+    pthread_mutex_unlock(&bn_pool_lock);
+    return job;
+}
+
+int bn_job_wait(bn_job *job) {
+    if (job == NULL) return BN_NULL_OBJECT;
+    pthread_mutex_lock(&bn_pool_lock);
+    while (!job->done) {
+        pthread_cond_wait(&bn_pool_done, &bn_pool_lock);
+    }
+    pthread_mutex_unlock(&bn_pool_lock);
+    return job->code;
+}
+
+int bn_job_ready(bn_job *job) {
+    if (job == NULL) return 0;
+    pthread_mutex_lock(&bn_pool_lock);
+    int done = job->done;
+    pthread_mutex_unlock(&bn_pool_lock);
+    return done;
+}
+#else
+bn_job *bn_job_submit(bn_job *job) {
+    bn_job_run(job);
+    job->done = 1;
+    return job;
+}
+
+int bn_job_wait(bn_job *job) {
+    if (job == NULL) return BN_NULL_OBJECT;
+    return job->code;
+}
+
+int bn_job_ready(bn_job *job) {
+    return job != NULL;
+}
+#endif
+
+bn_job *bn_job_new(int kind, int n, bn const *t, bn_progress_fn progress, void *arg) {
+    bn_job *job = (bn_job *)calloc(1, sizeof(bn_job));
+    if (job == NULL) return NULL;
+    job->kind = kind;
+    job->n = n;
+    job->value = t != NULL ? bn_init(t) : bn_new();
+    if (job->value == NULL) {
+        free(job);
+        return NULL;
+    }
+    job->ctl.cancel = &job->cancel;
+    job->ctl.progress = progress;
+    job->ctl.arg = arg;
+    return bn_job_submit(job);
+}
+
+bn_job *bn_factorial_async(int n, bn_progress_fn progress, void *arg) {
+    if (n < 1) return NULL;
+    return bn_job_new(BN_JOB_FACTORIAL, n, NULL, progress, arg);
+}
+
+bn_job *bn_pow_async(bn const *t, int degree, bn_progress_fn progress, void *arg) {
+    if (t == NULL || t->body == NULL) return NULL;
+    return bn_job_new(BN_JOB_POW, degree, t, progress, arg);
+}
+
+bn_job *bn_to_string_async(bn const *t, int radix, bn_progress_fn progress, void *arg) {
+    if (t == NULL || t->body == NULL || radix < 2 || radix > 36) return NULL;
+    return bn_job_new(BN_JOB_STRING, radix, t, progress, arg);
+}
+
+int bn_job_cancel(bn_job *job) {
+    if (job == NULL) return BN_NULL_OBJECT;
+    bn_flag_set(&job->cancel);
+    return BN_OK;
+}
+
+bn *bn_job_result(bn_job *job) {
+    if (bn_job_wait(job) != BN_OK || job->kind == BN_JOB_STRING) return NULL;
+    bn *ret = job->value;
+    job->value = NULL;
+    return ret;
+}
+
+const char *bn_job_string(bn_job *job) {
+    if (bn_job_wait(job) != BN_OK) return NULL;
+    char *ret = job->text;
+    job->text = NULL;
+    return ret;
+}
+
+int bn_job_free(bn_job *job) {
+    if (job == NULL) return BN_NULL_OBJECT;
+    bn_job_wait(job);
+    bn_delete(job->value);
+    free(job->text);
+    free(job);
+    return BN_OK;
+}
+
+int bn_spill(const char *dir, int min_digits) {
+    if (dir == NULL) {
+        bn_spill_min = 0;
+        return BN_OK;
+    }
+#ifndef _WIN32
+    if (strlen(dir) >= BN_SPILL_PATH || access(dir, W_OK) != 0) return BN_IO_ERROR;
+    strcpy(bn_spill_dir, dir);
+    bn_spill_min = min_digits > 0 ? min_digits : 1;
+    return BN_OK;
+#else
+    return BN_IO_ERROR;
+#endif
+}
+
+int bn_drop_digits(bn *t, int k) {
+    if (k >= t->bodysize) return bn_set_zero(t);
+    if (bn_unshare(t)) return BN_NO_MEMORY;
+    memmove(t->body, t->body + k, (t->bodysize - k) * sizeof(int));
+    t->bodysize -= k;
+    return BN_OK;
+}
+
+int bn_shift_digits(bn *t, int k) {
+    if (t->sign == 0 || k == 0) return BN_OK;
+    int size = t->bodysize + k;
+    int *body = bn_body_alloc(size);
+    if (body == NULL) return BN_NO_MEMORY;
+    memset(body, 0, k * sizeof(int));
+    memcpy(body + k, t->body, t->bodysize * sizeof(int));
+    return bn_set_digits(t, body, size, t->sign);
+}
+
+int bn_strip_factor(bn *x, bn *y, int p, int limit) {
+    int m = (int)bn_mod_ll(y, limit), f = 1;
+    while (f < limit && m % (f * p) == 0) {
+        f *= p;
+    }
+    if (bn_divmod_small(x, f) < 0 || bn_divmod_small(y, f) < 0) return BN_NO_MEMORY;
+    return BN_OK;
+}
+
+int bn_hensel_div(bn *q, bn const *a, bn const *b) {
+    static const int inv[10] = {0, 1, 0, 7, 0, 0, 0, 3, 0, 9};
+    int na = a->bodysize, nb = b->bodysize, nq = na - nb + 1;
+    if (nq < 1 || a->sign == 0) return bn_set_zero(q);
+    int *r = (int *)malloc(nq * sizeof(int));
+    if (r == NULL) return BN_NO_MEMORY;
+    memcpy(r, a->body, nq * sizeof(int));
+    if (bn_reserve(q, nq)) {
+        free(r);
+        return BN_NO_MEMORY;
+    }
+    int const *d = b->body;
+    int binv = inv[d[0]], i, j;
+    for (i = 0; i < nq; i++) {
+        int qd = r[i] * binv % 10;
+        q->body[i] = qd;
+        if (qd == 0) continue;
+        int m = nq - i < nb ? nq - i : nb, borrow = 0;
+        for (j = 0; j < m; j++) {
+            int v = r[i + j] - qd * d[j] - borrow;
+            borrow = 0;
+            if (v < 0) {
+                borrow = (9 - v) / 10;
+                v += borrow * 10;
+            }
+            r[i + j] = v;
+        }
+        for (j = i + m; borrow != 0 && j < nq; j++) {
+            int v = r[j] - borrow;
+            borrow = v < 0;
+            r[j] = v + 10 * borrow;
+        }
+    }
+    free(r);
+    bn_trim(q, nq, 1);
+    return BN_OK;
+}
+
+int bn_divexact_check(bn const *q, bn const *a, bn const *b) {
+    bn *t = bn_new();
+    if (t == NULL) return BN_NO_MEMORY;
+    int code = bn_mul_into(t, q, b);
+    if (code == BN_OK && bn_cmp(t, a) != 0) code = BN_INEXACT;
+    bn_delete(t);
+    return code;
+}
+
+int bn_divexact(bn *dst, bn const *a, bn const *b) {
+    if (dst == NULL || dst->body == NULL || a == NULL || a->body == NULL || b == NULL || b->body == NULL) return BN_NULL_OBJECT;
+    if (b->sign == 0) return BN_DIVIDE_BY_ZERO;
+    int sign = a->sign * b->sign, k = 0;
+    bn *x = bn_init(a), *y = bn_init(b);
+    int code = (x == NULL || y == NULL) ? BN_NO_MEMORY : BN_OK;
+    if (code == BN_OK) {
+        while (y->body[k] == 0) {
+            k++;
+        }
+        code = bn_drop_digits(x, k);
+    }
+    if (code == BN_OK) code = bn_drop_digits(y, k);
+    while (code == BN_OK && y->body[0] % 2 == 0) {
+        code = bn_strip_factor(x, y, 2, 1 << 26);
+    }
+    while (code == BN_OK && y->body[0] == 5) {
+        code = bn_strip_factor(x, y, 5, 48828125);
+    }
+    if (code == BN_OK) code = bn_hensel_div(x, x, y);
+    if (code == BN_OK && x->sign != 0) x->sign = sign;
+#ifndef NDEBUG
+    if (code == BN_OK) code = bn_divexact_check(x, a, b);
+#endif
+    if (code == BN_OK) code = bn_assign(dst, x);
+    bn_delete(x);
+    bn_delete(y);
+    return code;
+}
+
+#define BN_SPLIT_PARALLEL 64
+
+typedef struct {
+    bn_series const *s;
+    long n1, n2;
+    int need_p, threads, code;
+    bn *p, *q, *t;
+} bn_split_job;
+
+int bn_split_init(bn_split_job *j, bn_series const *s, long n1, long n2, int need_p, int threads) {
+    j->s = s;
+    j->n1 = n1;
+    j->n2 = n2;
+    j->need_p = need_p;
+    j->threads = threads;
+    j->p = need_p ? bn_new() : NULL;
+    j->q = bn_new();
+    j->t = bn_new();
+    j->code = ((need_p && j->p == NULL) || j->q == NULL || j->t == NULL) ? BN_NO_MEMORY : BN_OK;
+    return j->code;
+}
+
+void bn_split_free(bn_split_job *j) {
+    bn_delete(j->p);
+    bn_delete(j->q);
+    bn_delete(j->t);
+}
+
+int bn_split_term(bn *t, bn_term_fn f, long n, void *arg) {
+    return f == NULL ? bn_init_int(t, 1) : f(t, n, arg);
+}
+
+int bn_split_leaf(bn_split_job *j) {
+    bn_series const *s = j->s;
+    bn *p = j->p != NULL ? j->p : bn_new();
+    int code = p == NULL ? BN_NO_MEMORY : bn_split_term(p, s->p, j->n1, s->arg);
+    if (code == BN_OK) code = bn_split_term(j->q, s->q, j->n1, s->arg);
+    if (code == BN_OK) code = bn_split_term(j->t, s->a, j->n1, s->arg);
+    if (code == BN_OK) code = bn_mul_into(j->t, j->t, p);
+    if (p != j->p) bn_delete(p);
+    return code;
+}
+
+void *bn_split_run(void *arg) {
+    bn_split_job *j = (bn_split_job *)arg;
+    if (j->n2 - j->n1 == 1) {
+        j->code = bn_split_leaf(j);
+        return NULL;
+    }
+    long m = j->n1 + (j->n2 - j->n1) / 2;
+    bn_split_job l, r;
+    int code = bn_split_init(&l, j->s, j->n1, m, 1, j->threads / 2);
+    int c = bn_split_init(&r, j->s, m, j->n2, j->need_p, j->threads - j->threads / 2);
+    if (c > code) code = c;
+    if (code == BN_OK) {
+#ifndef _WIN32
+        pthread_t th;
+        if (j->threads > 1 && j->n2 - j->n1 >= BN_SPLIT_PARALLEL && pthread_create(&th, NULL, bn_split_run, &l) == 0) {
+            bn_split_run(&r);
+            pthread_join(th, NULL);
+        } else {
+            bn_split_run(&l);
+            bn_split_run(&r);
+        }
+#else
+        bn_split_run(&l);
+        bn_split_run(&r);
+#endif
+        code = l.code > r.code ? l.code : r.code;
+    }
+    if (code == BN_OK && j->need_p) code = bn_mul_into(j->p, l.p, r.p);
+    if (code == BN_OK) code = bn_mul_into(j->q, l.q, r.q);
+    if (code == BN_OK) code = bn_mul_into(r.t, l.p, r.t);
+    if (code == BN_OK) code = bn_mul_into(j->t, l.t, r.q);
+    if (code == BN_OK) code = bn_add_into(j->t, j->t, r.t);
+    bn_split_free(&l);
+    bn_split_free(&r);
+    j->code = code;
+    return NULL;
+}
+
+int bn_series_sum(bn *t, bn_series const *s, long count, int digits, int threads) {
+    if (t == NULL || t->body == NULL || s == NULL) return BN_NULL_OBJECT;
+    if (digits < 0) return BN_BAD_FORMAT;
+    if (count <= 0) return bn_set_zero(t);
+    bn_split_job j;
+    int code = bn_split_init(&j, s, 0, count, 0, threads > 0 ? threads : 1);
+    if (code == BN_OK) {
+        bn_split_run(&j);
+        code = j.code;
+    }
+    if (code == BN_OK) code = bn_shift_digits(j.t, digits);
+    if (code == BN_OK) code = bn_div_into(t, j.t, j.q);
+    bn_split_free(&j);
+    return code;
 }
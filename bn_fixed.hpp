@@ -0,0 +1,249 @@
+#pragma once
+//  bn_fixed.hpp:     FixedBn<Bits>
+// (   2^Bits)    
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "bn.hpp"
+
+namespace bn_detail {
+
+//    i = I..N-1   
+template <unsigned I, unsigned N>
+struct Unroll {
+    template <class F> static void run(F &f) {
+        f(I);
+        Unroll<I + 1, N>::run(f);
+    }
+};
+
+template <unsigned N>
+struct Unroll<N, N> {
+    template <class F> static void run(F &) {}
+};
+
+inline int clz32(uint32_t x) {
+    int n = 0;
+    while ((x & 0x80000000u) == 0) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+
+} // namespace bn_detail
+
+template <unsigned Bits>
+class FixedBn {
+    static_assert(Bits > 0 && Bits % 32 == 0, "FixedBn: Bits must be a positive multiple of 32");
+public:
+    static constexpr unsigned Limbs = Bits / 32;
+
+    //    2^32,  
+    uint32_t limb[Limbs];
+
+    FixedBn() : limb() {}
+    //   ;     Bits 
+    template <class T>
+    FixedBn(T value, typename std::enable_if<std::is_integral<T>::value, int>::type = 0) : limb() {
+        uint64_t u = (uint64_t)value;
+        bool negative = std::is_signed<T>::value && (int64_t)value < 0;
+        for (unsigned i = 0; i < Limbs; i++) {
+            limb[i] = i < 2 ? (uint32_t)(u >> (32 * i)) : negative ? 0xFFFFFFFFu : 0;
+        }
+    }
+    //  bn:     2^Bits ( -   )
+    explicit FixedBn(bn const *t) : limb() { assign(t); }
+    explicit FixedBn(BigInt const &t) : limb() { assign(t.get()); }
+
+    BigInt to_bigint() const {
+        char hex[Limbs * 8 + 1];
+        int pos = 0;
+        for (int i = Limbs - 1; i >= 0; i--) {
+            for (int shift = 28; shift >= 0; shift -= 4) {
+                hex[pos++] = "0123456789ABCDEF"[(limb[i] >> shift) & 15];
+            }
+        }
+        hex[pos] = '\0';
+        return BigInt(hex, 16);
+    }
+    //  bn;   bn_delete
+    bn *to_bn() const { return to_bigint().release(); }
+    std::string to_string(int radix = 10) const { return to_bigint().to_string(radix); }
+
+    bool is_zero() const {
+        uint32_t acc = 0;
+        auto f = [&](unsigned i) { acc |= limb[i]; };
+        bn_detail::Unroll<0, Limbs>::run(f);
+        return acc == 0;
+    }
+
+    friend FixedBn operator+(FixedBn const &a, FixedBn const &b) {
+        FixedBn r;
+        uint64_t carry = 0;
+        auto f = [&](unsigned i) {
+            carry += (uint64_t)a.limb[i] + b.limb[i];
+            r.limb[i] = (uint32_t)carry;
+            carry >>= 32;
+        };
+        bn_detail::Unroll<0, Limbs>::run(f);
+        return r;
+    }
+
+    friend FixedBn operator-(FixedBn const &a, FixedBn const &b) {
+        FixedBn r;
+        uint64_t borrow = 0;
+        auto f = [&](unsigned i) {
+            uint64_t d = (uint64_t)a.limb[i] - b.limb[i] - borrow;
+            r.limb[i] = (uint32_t)d;
+            borrow = (d >> 32) & 1;
+        };
+        bn_detail::Unroll<0, Limbs>::run(f);
+        return r;
+    }
+
+    FixedBn operator-() const { return FixedBn() - *this; }
+
+    // ,   Bits 
+    friend FixedBn operator*(FixedBn const &a, FixedBn const &b) {
+        FixedBn r;
+        auto row = [&](unsigned i) {
+            uint64_t carry = 0;
+            auto col = [&](unsigned j) {
+                if (i + j < Limbs) {
+                    carry += (uint64_t)a.limb[i] * b.limb[j] + r.limb[i + j];
+                    r.limb[i + j] = (uint32_t)carry;
+                    carry >>= 32;
+                }
+            };
+            bn_detail::Unroll<0, Limbs>::run(col);
+        };
+        bn_detail::Unroll<0, Limbs>::run(row);
+        return r;
+    }
+
+    friend FixedBn operator/(FixedBn const &a, FixedBn const &b) {
+        FixedBn q, r;
+        divmod(a, b, &q, &r);
+        return q;
+    }
+
+    friend FixedBn operator%(FixedBn const &a, FixedBn const &b) {
+        FixedBn q, r;
+        divmod(a, b, &q, &r);
+        return r;
+    }
+
+    FixedBn &operator+=(FixedBn const &b) { return *this = *this + b; }
+    FixedBn &operator-=(FixedBn const &b) { return *this = *this - b; }
+    FixedBn &operator*=(FixedBn const &b) { return *this = *this * b; }
+    FixedBn &operator/=(FixedBn const &b) { return *this = *this / b; }
+    FixedBn &operator%=(FixedBn const &b) { return *this = *this % b; }
+
+    friend int compare(FixedBn const &a, FixedBn const &b) {
+        for (int i = Limbs - 1; i >= 0; i--) {
+            if (a.limb[i] != b.limb[i]) return a.limb[i] < b.limb[i] ? -1 : 1;
+        }
+        return 0;
+    }
+    friend bool operator==(FixedBn const &a, FixedBn const &b) { return compare(a, b) == 0; }
+    friend bool operator!=(FixedBn const &a, FixedBn const &b) { return compare(a, b) != 0; }
+    friend bool operator<(FixedBn const &a, FixedBn const &b) { return compare(a, b) < 0; }
+    friend bool operator>(FixedBn const &a, FixedBn const &b) { return compare(a, b) > 0; }
+    friend bool operator<=(FixedBn const &a, FixedBn const &b) { return compare(a, b) <= 0; }
+    friend bool operator>=(FixedBn const &a, FixedBn const &b) { return compare(a, b) >= 0; }
+
+    //   ( D)   2^32
+    static void divmod(FixedBn const &a, FixedBn const &b, FixedBn *q, FixedBn *r) {
+        int n = Limbs, m = Limbs;
+        while (n > 0 && b.limb[n - 1] == 0) n--;
+        while (m > 0 && a.limb[m - 1] == 0) m--;
+        if (n == 0) throw std::domain_error("FixedBn: division by zero");
+        *q = FixedBn();
+        *r = FixedBn();
+        if (m < n) {
+            *r = a;
+            return;
+        }
+        if (n == 1) {
+            uint64_t rem = 0;
+            for (int i = m - 1; i >= 0; i--) {
+                rem = (rem << 32) | a.limb[i];
+                q->limb[i] = (uint32_t)(rem / b.limb[0]);
+                rem %= b.limb[0];
+            }
+            r->limb[0] = (uint32_t)rem;
+            return;
+        }
+        int s = bn_detail::clz32(b.limb[n - 1]);
+        uint32_t vn[Limbs], un[Limbs + 1];
+        for (int i = n - 1; i > 0; i--) {
+            vn[i] = (b.limb[i] << s) | (s ? b.limb[i - 1] >> (32 - s) : 0);
+        }
+        vn[0] = b.limb[0] << s;
+        un[m] = s ? a.limb[m - 1] >> (32 - s) : 0;
+        for (int i = m - 1; i > 0; i--) {
+            un[i] = (a.limb[i] << s) | (s ? a.limb[i - 1] >> (32 - s) : 0);
+        }
+        un[0] = a.limb[0] << s;
+        const uint64_t base = (uint64_t)1 << 32;
+        for (int j = m - n; j >= 0; j--) {
+            uint64_t num = ((uint64_t)un[j + n] << 32) | un[j + n - 1];
+            uint64_t qhat = num / vn[n - 1];
+            uint64_t rhat = num % vn[n - 1];
+            while (qhat >= base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                qhat--;
+                rhat += vn[n - 1];
+                if (rhat >= base) break;
+            }
+            int64_t t;
+            uint64_t k = 0;
+            for (int i = 0; i < n; i++) {
+                uint64_t p = qhat * vn[i];
+                t = (int64_t)un[i + j] - (int64_t)k - (int64_t)(p & 0xFFFFFFFFu);
+                un[i + j] = (uint32_t)t;
+                k = (p >> 32) - (t >> 32);
+            }
+            t = (int64_t)un[j + n] - (int64_t)k;
+            un[j + n] = (uint32_t)t;
+            q->limb[j] = (uint32_t)qhat;
+            if (t < 0) {
+                q->limb[j]--;
+                k = 0;
+                for (int i = 0; i < n; i++) {
+                    uint64_t sum = (uint64_t)un[i + j] + vn[i] + k;
+                    un[i + j] = (uint32_t)sum;
+                    k = sum >> 32;
+                }
+                un[j + n] += (uint32_t)k;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            r->limb[i] = (un[i] >> s) | (s ? un[i + 1] << (32 - s) : 0);
+        }
+    }
+
+private:
+    void assign(bn const *t) {
+        size_t len = bn_sizeinbase(t, 16) + 2;
+        std::vector<char> buf(len);
+        bn_detail::check(bn_to_string_buf(t, 16, &buf[0], len));
+        const char *s = &buf[0];
+        bool negative = *s == '-';
+        if (negative) s++;
+        int digits = (int)std::char_traits<char>::length(s);
+        for (int i = 0; i < digits && i < (int)Limbs * 8; i++) {
+            char c = s[digits - 1 - i];
+            uint32_t d = c <= '9' ? c - '0' : c - 'A' + 10;
+            limb[i / 8] |= d << (4 * (i % 8));
+        }
+        if (negative) *this = -*this;
+    }
+};
+
+typedef FixedBn<256> Bn256;
+typedef FixedBn<384> Bn384;
+typedef FixedBn<512> Bn512;